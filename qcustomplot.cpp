@@ -27,6 +27,7 @@
 
 #include <src/vector2d.cpp>
 #include <src/painter.cpp>
+#include <src/linerasterizer.cpp>
 #include <src/paintbuffer.cpp>
 #include <src/layer.cpp>
 #include <src/axis/range.cpp>
@@ -60,6 +61,8 @@
 #include <src/plottables/plottable-colormap.cpp>
 #include <src/plottables/plottable-financial.cpp>
 #include <src/plottables/plottable-errorbar.cpp>
+#include <src/plottables/plottable-linedensity.cpp>
+#include <src/plottables/plottable-contour.cpp>
 #include <src/items/item-straightline.cpp>
 #include <src/items/item-line.cpp>
 #include <src/items/item-curve.cpp>
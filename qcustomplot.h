@@ -131,6 +131,7 @@ class QCPPolarGraph;
 #include <src/global.h>
 #include <src/vector2d.h>
 #include <src/painter.h>
+#include <src/linerasterizer.h>
 #include <src/paintbuffer.h>
 #include <src/layer.h>
 #include <src/axis/range.h>
@@ -149,6 +150,7 @@ class QCPPolarGraph;
 #include <src/axis/axis.h>
 #include <src/scatterstyle.h>
 #include <src/datacontainer.h>
+#include <src/parallel.h>
 #include <src/plottable.h>
 #include <src/item.h>
 #include <src/core.h>
@@ -166,6 +168,8 @@ class QCPPolarGraph;
 #include <src/plottables/plottable-colormap.h>
 #include <src/plottables/plottable-financial.h>
 #include <src/plottables/plottable-errorbar.h>
+#include <src/plottables/plottable-linedensity.h>
+#include <src/plottables/plottable-contour.h>
 #include <src/items/item-straightline.h>
 #include <src/items/item-line.h>
 #include <src/items/item-curve.h>
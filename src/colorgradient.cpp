@@ -48,7 +48,9 @@ QCPColorGradient::QCPColorGradient() :
   mNanHandling(nhNone),
   mNanColor(Qt::black),
   mPeriodic(false),
-  mColorBufferInvalidated(true)
+  mColorBufferInvalidated(true),
+  mLogTableLevelCount(0),
+  mLogTableMantissaBits(0)
 {
   mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
 }
@@ -65,7 +67,9 @@ QCPColorGradient::QCPColorGradient(GradientPreset preset) :
   mNanHandling(nhNone),
   mNanColor(Qt::black),
   mPeriodic(false),
-  mColorBufferInvalidated(true)
+  mColorBufferInvalidated(true),
+  mLogTableLevelCount(0),
+  mLogTableMantissaBits(0)
 {
   mColorBuffer.fill(qRgb(0, 0, 0), mLevelCount);
   loadPreset(preset);
@@ -208,7 +212,6 @@ void QCPColorGradient::setPeriodic(bool enabled)
 */
 void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
   if (!data)
   {
     qDebug() << Q_FUNC_INFO << "null pointer given as data";
@@ -219,39 +222,7 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
     qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
     return;
   }
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
-  
-  const bool skipNanCheck = mNanHandling == nhNone;
-  const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
-  {
-    const double value = data[dataIndexFactor*i];
-    if (skipNanCheck || !std::isnan(value))
-    {
-      qint64 index = qint64((!logarithmic ? value-range.lower : qLn(value/range.lower)) * posToIndexFactor);
-      if (!mPeriodic)
-      {
-        index = qBound(qint64(0), index, qint64(mLevelCount-1));
-      } else
-      {
-        index %= mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-      }
-      scanLine[i] = mColorBuffer.at(index);
-    } else
-    {
-      switch(mNanHandling)
-      {
-      case nhLowestColor: scanLine[i] = mColorBuffer.first(); break;
-      case nhHighestColor: scanLine[i] = mColorBuffer.last(); break;
-      case nhTransparent: scanLine[i] = qRgba(0, 0, 0, 0); break;
-      case nhNanColor: scanLine[i] = mNanColor.rgba(); break;
-      case nhNone: break; // shouldn't happen
-      }
-    }
-  }
+  colorizeValues(data, nullptr, range, scanLine, n, dataIndexFactor, logarithmic);
 }
 
 /*! \overload
@@ -264,7 +235,6 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
 */
 void QCPColorGradient::colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
   if (!data)
   {
     qDebug() << Q_FUNC_INFO << "null pointer given as data";
@@ -280,47 +250,167 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
     qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
     return;
   }
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
-  
-  const bool skipNanCheck = mNanHandling == nhNone;
-  const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  colorizeValues(data, alpha, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+
+  Converts single precision \a data to colors. Apart from the data type, this method behaves like
+  the overload for double precision data. The values are read in their single precision form, so
+  colorizing float data needs only half the memory bandwidth.
+*/
+void QCPColorGradient::colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
   {
-    const double value = data[dataIndexFactor*i];
-    if (skipNanCheck || !std::isnan(value))
-    {
-      qint64 index = qint64((!logarithmic ? value-range.lower : qLn(value/range.lower)) * posToIndexFactor);
-      if (!mPeriodic)
-      {
-        index = qBound(qint64(0), index, qint64(mLevelCount-1));
-      } else
-      {
-        index %= mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-      }
-      if (alpha[dataIndexFactor*i] == 255)
-      {
-        scanLine[i] = mColorBuffer.at(index);
-      } else
-      {
-        const QRgb rgb = mColorBuffer.at(index);
-        const float alphaF = alpha[dataIndexFactor*i]/255.0f;
-        scanLine[i] = qRgba(int(qRed(rgb)*alphaF), int(qGreen(rgb)*alphaF), int(qBlue(rgb)*alphaF), int(qAlpha(rgb)*alphaF)); // also multiply r,g,b with alpha, to conform to Format_ARGB32_Premultiplied
-      }
-    } else
-    {
-      switch(mNanHandling)
-      {
-      case nhLowestColor: scanLine[i] = mColorBuffer.first(); break;
-      case nhHighestColor: scanLine[i] = mColorBuffer.last(); break;
-      case nhTransparent: scanLine[i] = qRgba(0, 0, 0, 0); break;
-      case nhNanColor: scanLine[i] = mNanColor.rgba(); break;
-      case nhNone: break; // shouldn't happen
-      }
-    }
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
   }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeValues(data, nullptr, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+
+  Converts single precision \a data to colors and applies the alpha map \a alpha, which has the
+  same size and structure as \a data.
+*/
+void QCPColorGradient::colorize(const float *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeValues(data, alpha, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+
+  Converts 16 bit integer \a data to colors, by directly looking up the color of each value in \a
+  lookupTable. The table must have at least as many entries as the largest value in \a data plus
+  one, and is typically created with \ref lookupTable. This avoids all floating point operations
+  per value, so it is the fastest way to colorize integer data such as camera frames.
+
+  \a data is addressed <tt>data[i*dataIndexFactor]</tt>, like in the other overloads.
+*/
+void QCPColorGradient::colorize(const quint16 *data, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeIndices(data, nullptr, lookupTable, scanLine, n, dataIndexFactor);
+}
+
+/*! \overload
+
+  Converts 16 bit integer \a data to colors with \a lookupTable, and applies the alpha map \a
+  alpha, which has the same size and structure as \a data.
+*/
+void QCPColorGradient::colorize(const quint16 *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeIndices(data, alpha, lookupTable, scanLine, n, dataIndexFactor);
+}
+
+/*! \overload
+
+  Converts 8 bit integer \a data to colors with \a lookupTable, see the overload for 16 bit
+  integer data.
+*/
+void QCPColorGradient::colorize(const quint8 *data, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeIndices(data, nullptr, lookupTable, scanLine, n, dataIndexFactor);
+}
+
+/*! \overload
+
+  Converts 8 bit integer \a data to colors with \a lookupTable, and applies the alpha map \a
+  alpha, which has the same size and structure as \a data.
+*/
+void QCPColorGradient::colorize(const quint8 *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeIndices(data, alpha, lookupTable, scanLine, n, dataIndexFactor);
+}
+
+/*!
+  Returns a table of the colors of the integer values 0 to <tt>valueCount-1</tt>, for use with the
+  integer overloads of \ref colorize. Integer value \a i represents the data value
+  <tt>i*scale + offset</tt>, which is mapped to the gradient with the data \a range, just like the
+  \ref colorize overload for double data would.
+
+  The table only needs to be created again when one of the parameters or the gradient changes.
+  For 16 bit data, \a valueCount is typically 65536.
+*/
+QVector<QRgb> QCPColorGradient::lookupTable(int valueCount, double scale, double offset, const QCPRange &range, bool logarithmic)
+{
+  QVector<QRgb> result(qMax(0, valueCount));
+  QVector<double> values(result.size());
+  for (int i=0; i<values.size(); ++i)
+    values[i] = i*scale + offset;
+  if (!values.isEmpty())
+    colorizeValues(values.constData(), nullptr, range, result.data(), result.size(), 1, logarithmic);
+  return result;
 }
 
 /*! \internal
@@ -337,9 +427,11 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
 */
 QRgb QCPColorGradient::color(double position, const QCPRange &range, bool logarithmic)
 {
-  // If you change something here, make sure to also adapt ::colorize()
+  // If you change something here, make sure to also adapt ::colorize() and ::colorizeChunk()
   if (mColorBufferInvalidated)
     updateColorBuffer();
+  if (logarithmic && !mPeriodic && !logLevelTableValid(range)) // not used here, but this way color() prepares all state colorize() needs
+    updateLogLevelTable(range);
   
   const bool skipNanCheck = mNanHandling == nhNone;
   if (!skipNanCheck && std::isnan(position))
@@ -520,6 +612,214 @@ bool QCPColorGradient::stopsUseAlpha() const
   return false;
 }
 
+/*! \internal
+
+  Implements the floating point overloads of \ref colorize for \a data of type \a T (double or
+  float). If \a alpha is not \c nullptr, the alpha map is applied to the colors afterwards. Cells
+  with NaN data keep their NaN color (see \ref setNanHandling) regardless of the alpha map.
+*/
+template <typename T>
+void QCPColorGradient::colorizeValues(const T *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  // If you change something here, make sure to also adapt color() and colorizeChunk()
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
+  if (logarithmic && !mPeriodic && !logLevelTableValid(range))
+    updateLogLevelTable(range);
+  
+  const int chunkSize = 256; // size of the intermediate buffers in colorizeChunk
+  for (int chunkBegin=0; chunkBegin<n; chunkBegin+=chunkSize)
+  {
+    const int chunkCount = qMin(chunkSize, n-chunkBegin);
+    colorizeChunk(data+qint64(chunkBegin)*dataIndexFactor, range, scanLine+chunkBegin, chunkCount, dataIndexFactor, logarithmic);
+  }
+  const bool skipNanCheck = mNanHandling == nhNone;
+  if (!skipNanCheck)
+  {
+    QRgb nanRgb = 0;
+    switch(mNanHandling)
+    {
+    case nhLowestColor: nanRgb = mColorBuffer.at(0); break; // const access, so concurrent calls don't race on a detach of the shared buffer
+    case nhHighestColor: nanRgb = mColorBuffer.at(mColorBuffer.size()-1); break;
+    case nhTransparent: nanRgb = qRgba(0, 0, 0, 0); break;
+    case nhNanColor: nanRgb = mNanColor.rgba(); break;
+    case nhNone: break; // shouldn't happen
+    }
+    for (int i=0; i<n; ++i)
+    {
+      if (std::isnan(data[dataIndexFactor*i]))
+        scanLine[i] = nanRgb;
+    }
+  }
+  if (alpha)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      const int alphaValue = alpha[dataIndexFactor*i];
+      if (alphaValue != 255 && (skipNanCheck || !std::isnan(data[dataIndexFactor*i]))) // NaN colors are not affected by the alpha map
+        scanLine[i] = applyAlpha(scanLine[i], alphaValue);
+    }
+  }
+}
+
+/*! \internal
+
+  Implements the integer overloads of \ref colorize for \a data of type \a T (quint16 or quint8),
+  by looking up the colors in \a lookupTable. Values beyond the end of the table get the color of
+  the last entry. If \a alpha is not \c nullptr, the alpha map is applied to the colors afterwards.
+*/
+template <typename T>
+void QCPColorGradient::colorizeIndices(const T *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const
+{
+  if (lookupTable.isEmpty())
+  {
+    qDebug() << Q_FUNC_INFO << "empty lookup table";
+    return;
+  }
+  const QRgb *colors = lookupTable.constData();
+  const int maxIndex = lookupTable.size()-1;
+  if (maxIndex >= int(std::numeric_limits<T>::max())) // table covers all values of T, so no bounds check is needed
+  {
+    for (int i=0; i<n; ++i)
+      scanLine[i] = colors[data[i*dataIndexFactor]];
+  } else
+  {
+    for (int i=0; i<n; ++i)
+      scanLine[i] = colors[qMin(int(data[i*dataIndexFactor]), maxIndex)];
+  }
+  if (alpha)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      const int alphaValue = alpha[dataIndexFactor*i];
+      if (alphaValue != 255)
+        scanLine[i] = applyAlpha(scanLine[i], alphaValue);
+    }
+  }
+}
+
+/*! \internal
+
+  Returns the premultiplied color \a rgb with all components multiplied by \a alpha (0 to 255), as
+  used to apply the alpha map in \ref colorize.
+*/
+QRgb QCPColorGradient::applyAlpha(QRgb rgb, int alpha)
+{
+  const float alphaF = alpha/255.0f;
+  return qRgba(int(qRed(rgb)*alphaF), int(qGreen(rgb)*alphaF), int(qBlue(rgb)*alphaF), int(qAlpha(rgb)*alphaF)); // also multiply r,g,b with alpha, to conform to Format_ARGB32_Premultiplied
+}
+
+/*! \internal
+
+  Converts the \a n data values in \a data (addressed <tt>data[i*dataIndexFactor]</tt>) to colors of
+  the color buffer and writes them to \a scanLine. \a T is the floating point type of the data. This
+  is the core of \ref colorize, which calls it for chunks of a few hundred values, so the
+  intermediate arrays fit on the stack and in the cache. \a n must not exceed the size of these
+  arrays (256).
+
+  The work is split into separate tight loops (data to level position, level position to index,
+  index to color), which don't branch per value in the linear, non-periodic case. This lets
+  compilers auto-vectorize them for the instruction set the library is built for. NaN values end
+  up with the lowest color here, the NaN handling is applied afterwards by \ref colorizeValues.
+
+  On non-periodic logarithmic ranges, the level table created by \ref updateLogLevelTable replaces
+  the first two loops, so most values don't need a logarithm to be calculated.
+
+  The color buffer must be up to date (see \ref updateColorBuffer) when calling this method.
+*/
+template <typename T>
+void QCPColorGradient::colorizeChunk(const T *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic) const
+{
+  double positions[256];
+  int indices[256];
+  const int maxIndex = mLevelCount-1;
+  
+  if (logarithmic && !mPeriodic && logLevelTableValid(range) && !mLogTableLevels.isEmpty())
+  {
+    // map data values directly to color buffer indices, via the bucket of their ratio to range.lower:
+    const double posToIndexFactor = maxIndex/qLn(range.upper/range.lower);
+    const double inverseLower = 1.0/range.lower;
+    const double maxRatio = range.upper/range.lower; // calculated like in updateLogLevelTable, so all smaller ratios have a bucket
+    const int *levels = mLogTableLevels.constData();
+    const double *thresholds = mLogTableThresholds.constData();
+    const int mantissaShift = 52-mLogTableMantissaBits;
+    const quint64 exponentBias = quint64(1023) << mLogTableMantissaBits;
+    for (int i=0; i<n; ++i)
+    {
+      const double ratio = data[i*dataIndexFactor]*inverseLower;
+      if (!(ratio > 1.0)) // below the range, or NaN
+      {
+        indices[i] = 0;
+      } else if (ratio >= maxRatio)
+      {
+        indices[i] = maxIndex;
+      } else
+      {
+        quint64 bits;
+        memcpy(&bits, &ratio, sizeof(bits));
+        const int bucket = int((bits >> mantissaShift) - exponentBias);
+        const int level = levels[bucket];
+        if (level >= 0)
+          indices[i] = ratio >= thresholds[bucket] ? level+1 : level;
+        else // bucket spans several levels
+          indices[i] = qBound(0, int(std::log(ratio)*posToIndexFactor), maxIndex);
+      }
+    }
+  } else
+  {
+    // map data values to (fractional) color levels:
+    if (!logarithmic)
+    {
+      const double posToIndexFactor = maxIndex/range.size();
+      const double lower = range.lower;
+      if (dataIndexFactor == 1)
+      {
+        for (int i=0; i<n; ++i)
+          positions[i] = (data[i]-lower)*posToIndexFactor;
+      } else
+      {
+        for (int i=0; i<n; ++i)
+          positions[i] = (data[i*dataIndexFactor]-lower)*posToIndexFactor;
+      }
+    } else
+    {
+      const double posToIndexFactor = maxIndex/qLn(range.upper/range.lower);
+      const double inverseLower = 1.0/range.lower;
+      for (int i=0; i<n; ++i)
+        positions[i] = std::log(data[i*dataIndexFactor]*inverseLower)*posToIndexFactor;
+    }
+    
+    // map levels to color buffer indices:
+    if (!mPeriodic)
+    {
+      // bounding before the integer conversion is equivalent to bounding the truncated index, and
+      // maps NaN to 0 (qMin(max, NaN) returns NaN, qMax(0, NaN) returns 0):
+      const double maxPosition = maxIndex;
+      for (int i=0; i<n; ++i)
+        indices[i] = int(qMax(0.0, qMin(maxPosition, positions[i])));
+    } else
+    {
+      for (int i=0; i<n; ++i)
+      {
+        if (std::isnan(positions[i]))
+        {
+          indices[i] = 0;
+          continue;
+        }
+        qint64 index = qint64(positions[i]) % mLevelCount;
+        if (index < 0)
+          index += mLevelCount;
+        indices[i] = int(index);
+      }
+    }
+  }
+  
+  // look up colors:
+  const QRgb *colors = mColorBuffer.constData();
+  for (int i=0; i<n; ++i)
+    scanLine[i] = colors[indices[i]];
+}
+
 /*! \internal
   
   Updates the internal color buffer which will be used by \ref colorize and \ref color, to quickly
@@ -630,6 +930,83 @@ void QCPColorGradient::updateColorBuffer()
   }
   mColorBufferInvalidated = false;
 }
+
+/*! \internal
+  
+  Returns whether the logarithmic level table (see \ref updateLogLevelTable) was created for the
+  data \a range and the current level count.
+  
+  The table may still be empty, if it can't be used for \a range. Since this state is also up to
+  date, colorizing in parallel never causes the table to be recreated by the worker threads, as
+  long as it was prepared beforehand (e.g. by a call to \ref color). \ref colorizeChunk checks
+  whether the table is empty before using it.
+*/
+bool QCPColorGradient::logLevelTableValid(const QCPRange &range) const
+{
+  return mLogTableRange == range && mLogTableLevelCount == mLevelCount;
+}
+
+/*! \internal
+  
+  Creates the table that \ref colorizeChunk uses to map data values to color levels on a
+  logarithmic data \a range, without calculating a logarithm per value.
+  
+  The table divides the ratios <tt>value/range.lower</tt> between 1 and
+  <tt>range.upper/range.lower</tt> into buckets, addressed by the exponent and the upper mantissa
+  bits of the IEEE 754 double representation of the ratio. The buckets are chosen small enough
+  that most of them contain at most one level boundary. For each bucket, the table holds the level
+  at its lower end and the ratio at which the next level begins, so the level of a value is found
+  with one table lookup and one comparison. Buckets spanning more than one level boundary are
+  marked with level -1, and their values fall back to calculating the logarithm.
+  
+  If the range spans too many octaves, or the ratios decrease (ranges with negative bounds), the
+  table stays empty and all values are colorized by calculating the logarithm.
+*/
+void QCPColorGradient::updateLogLevelTable(const QCPRange &range)
+{
+  mLogTableRange = range;
+  mLogTableLevelCount = mLevelCount;
+  mLogTableLevels.clear();
+  mLogTableThresholds.clear();
+  const double maxRatio = range.upper/range.lower;
+  if (!(maxRatio > 1.0) || !qIsFinite(maxRatio))
+    return;
+  int octaves = 0; // all ratios below maxRatio have a binary exponent below this
+  std::frexp(maxRatio, &octaves);
+  if (octaves > 64)
+    return;
+  
+  const int maxIndex = mLevelCount-1;
+  const double posToIndexFactor = maxIndex/std::log(maxRatio);
+  // about two buckets per level, but at most 65536 buckets in total:
+  int mantissaBits = qBound(4, int(std::ceil(std::log2(posToIndexFactor*std::log(2.0))))+1, 12);
+  while ((octaves << mantissaBits) > 65536 && mantissaBits > 4)
+    --mantissaBits;
+  const int bucketsPerOctave = 1 << mantissaBits;
+  const int bucketCount = octaves*bucketsPerOctave;
+  mLogTableLevels.resize(bucketCount);
+  mLogTableThresholds.resize(bucketCount);
+  for (int bucket=0; bucket<bucketCount; ++bucket)
+  {
+    const int octave = bucket/bucketsPerOctave;
+    const int mantissa = bucket%bucketsPerOctave;
+    const double lowerRatio = std::ldexp(1.0+mantissa/double(bucketsPerOctave), octave);
+    const double upperRatio = std::ldexp(1.0+(mantissa+1)/double(bucketsPerOctave), octave);
+    const int lowerLevel = qBound(0, int(std::log(lowerRatio)*posToIndexFactor), maxIndex);
+    const int upperLevel = qBound(0, int(std::log(upperRatio)*posToIndexFactor), maxIndex);
+    if (upperLevel == lowerLevel)
+    {
+      mLogTableLevels[bucket] = lowerLevel;
+      mLogTableThresholds[bucket] = std::numeric_limits<double>::infinity();
+    } else if (upperLevel == lowerLevel+1)
+    {
+      mLogTableLevels[bucket] = lowerLevel;
+      mLogTableThresholds[bucket] = std::exp(upperLevel/posToIndexFactor);
+    } else
+      mLogTableLevels[bucket] = -1;
+  }
+  mLogTableMantissaBits = mantissaBits;
+}
 /* end of 'src/colorgradient.cpp' */
 
 
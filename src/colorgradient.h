@@ -73,6 +73,13 @@ public:
   // non-property methods:
   void colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
   void colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const float *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const quint16 *data, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor=1) const;
+  void colorize(const quint16 *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor=1) const;
+  void colorize(const quint8 *data, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor=1) const;
+  void colorize(const quint8 *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor=1) const;
+  QVector<QRgb> lookupTable(int valueCount, double scale, double offset, const QCPRange &range, bool logarithmic=false);
   QRgb color(double position, const QCPRange &range, bool logarithmic=false);
   void loadPreset(GradientPreset preset);
   void clearColorStops();
@@ -90,10 +97,20 @@ protected:
   // non-property members:
   QVector<QRgb> mColorBuffer; // have colors premultiplied with alpha (for usage with QImage::Format_ARGB32_Premultiplied)
   bool mColorBufferInvalidated;
+  QVector<int> mLogTableLevels; // per bucket of the ratio value/range.lower: color level at the bucket's lower end, -1 if the bucket spans several levels
+  QVector<double> mLogTableThresholds; // per bucket: ratio at which the next color level begins
+  QCPRange mLogTableRange; // data range the logarithmic level table was created for
+  int mLogTableLevelCount, mLogTableMantissaBits;
   
   // non-virtual methods:
   bool stopsUseAlpha() const;
   void updateColorBuffer();
+  bool logLevelTableValid(const QCPRange &range) const;
+  void updateLogLevelTable(const QCPRange &range);
+  template <typename T> void colorizeValues(const T *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic);
+  template <typename T> void colorizeIndices(const T *data, const unsigned char *alpha, const QVector<QRgb> &lookupTable, QRgb *scanLine, int n, int dataIndexFactor) const;
+  template <typename T> void colorizeChunk(const T *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic) const;
+  static QRgb applyAlpha(QRgb rgb, int alpha);
 };
 Q_DECLARE_METATYPE(QCPColorGradient::ColorInterpolation)
 Q_DECLARE_METATYPE(QCPColorGradient::NanHandling)
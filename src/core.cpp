@@ -659,11 +659,20 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 /*!
   Sets the plotting hints for this QCustomPlot instance as an \a or combination of QCP::PlottingHint.
   
+  If \ref QCP::phRasterizedLines is toggled, the paint buffers are recreated with the respective
+  type.
+  
   \see setPlottingHint
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool paintBufferTypeChanged = mPlottingHints.testFlag(QCP::phRasterizedLines) != hints.testFlag(QCP::phRasterizedLines);
   mPlottingHints = hints;
+  if (paintBufferTypeChanged && !mOpenGl)
+  {
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
 }
 
 /*!
@@ -2618,9 +2627,10 @@ void QCustomPlot::setupPaintBuffers()
 
   This method is used by \ref setupPaintBuffers when it needs to create new paint buffers.
 
-  Depending on the current setting of \ref setOpenGl, and the current Qt version, different
-  backends (subclasses of \ref QCPAbstractPaintBuffer) are created, initialized with the proper
-  size and device pixel ratio, and returned.
+  Depending on the current setting of \ref setOpenGl, the \ref QCP::phRasterizedLines plotting
+  hint, and the current Qt version, different backends (subclasses of \ref
+  QCPAbstractPaintBuffer) are created, initialized with the proper size and device pixel ratio, and
+  returned.
 */
 QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
 {
@@ -2634,7 +2644,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mPlottingHints.testFlag(QCP::phRasterizedLines))
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -269,6 +269,7 @@ protected:
   friend class QCPAxisRect;
   friend class QCPAbstractPlottable;
   friend class QCPGraph;
+  friend class QCPBars;
   friend class QCPAbstractItem;
 };
 Q_DECLARE_METATYPE(QCustomPlot::LayerInsertMode)
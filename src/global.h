@@ -241,6 +241,8 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phRasterizedLines  = 0x008 ///< <tt>0x008</tt> QImage paint buffers are used instead of QPixmap, and solid one pixel wide Graph/Curve lines are drawn directly into them
+                                                ///<                with a software rasterizer (\ref QCPLineRasterizer), bypassing QPainter's generic stroker. Not used for OpenGL or vectorized export.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -0,0 +1,207 @@
+#include "src/linerasterizer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLineRasterizer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLineRasterizer
+  \brief Software rasterizer for thin solid lines, drawing directly into a QImage
+
+  This class is used internally by plottables to draw solid, cosmetic (one pixel wide) polylines
+  much faster than QPainter's generic stroker does. It computes the pixel coverage of each line
+  segment with Xiaolin Wu's algorithm (see \ref traceSegment) and blends the pen color directly
+  into the pixels of the QImage the painter is drawing on.
+
+  The rasterizer is only applicable if the painter draws on a QImage with a 32 bit RGB format
+  (e.g. the paint buffers created with \ref QCP::phRasterizedLines), with a solid cosmetic pen, a
+  scaling/translating transform and at most a rectangular clip region. Vectorized painting (\ref
+  QCPPainter::pmVectorized) is never handled. Whether the rasterizer can be used for a given
+  painter state can be checked with \ref isValid after construction. If it is not valid, the
+  caller must fall back to regular QPainter drawing.
+
+  Since the painter state is captured at construction, a QCPLineRasterizer instance should only
+  be used immediately after creation, while the painter state is unchanged.
+*/
+
+/*!
+  Creates a line rasterizer for the current state of \a painter (pen, transform, clipping,
+  antialiasing and paint device). Check \ref isValid to find out whether the painter state allows
+  rasterized drawing.
+*/
+QCPLineRasterizer::QCPLineRasterizer(QCPPainter *painter) :
+  mImage(nullptr),
+  mColor(0),
+  mAntialiased(false)
+{
+  if (!painter || !painter->isActive() || painter->modes().testFlag(QCPPainter::pmVectorized))
+    return;
+  if (!painter->device() || painter->device()->devType() != QInternal::Image)
+    return;
+  QImage *image = static_cast<QImage*>(painter->device());
+  if (image->format() != QImage::Format_ARGB32_Premultiplied && image->format() != QImage::Format_RGB32)
+    return;
+  const QPen pen = painter->pen();
+  if (pen.style() != Qt::SolidLine || pen.brush().style() != Qt::SolidPattern)
+    return;
+  if (!qFuzzyIsNull(pen.widthF()) && !(pen.isCosmetic() && pen.widthF() <= 1.0)) // only handle one pixel wide lines
+    return;
+  if (painter->compositionMode() != QPainter::CompositionMode_SourceOver)
+    return;
+  const QTransform transform = painter->deviceTransform();
+  if (transform.type() > QTransform::TxScale)
+    return;
+  QRect clipRect = image->rect();
+  if (painter->hasClipping())
+  {
+    const QRegion clipRegion = painter->clipRegion();
+    if (clipRegion.rectCount() > 1)
+      return;
+    clipRect &= transform.mapRect(QRectF(clipRegion.boundingRect())).toRect();
+  }
+
+  QColor color = pen.color();
+  color.setAlphaF(color.alphaF()*painter->opacity());
+  mImage = image;
+  mTransform = transform;
+  mClipRect = clipRect;
+  mColor = qPremultiply(color.rgba());
+  mAntialiased = painter->antialiasing();
+}
+
+/*!
+  Draws the polyline given by \a pointCount \a points (in logical painter coordinates) into the
+  image. NaN or infinite points create a gap in the line, like in \ref
+  QCPAbstractPlottable1D::drawPolyline.
+
+  The segments are traced half-open (see \ref traceSegment), so every pixel of the polyline,
+  including the joints, is blended once with its full coverage.
+
+  Does nothing if the rasterizer is not valid (see \ref isValid).
+*/
+void QCPLineRasterizer::drawPolyline(const QPointF *points, int pointCount)
+{
+  if (!mImage || mClipRect.isEmpty() || qAlpha(mColor) == 0)
+    return;
+
+  uchar *bits = mImage->bits();
+  const int bytesPerLine = mImage->bytesPerLine();
+  const QRect clipRect = mClipRect;
+  const QRgb color = mColor;
+  auto blendPixel = [bits, bytesPerLine, clipRect, color](int x, int y, double coverage)
+  {
+    if (!clipRect.contains(x, y))
+      return;
+    const uint alpha = uint(qMin(coverage, 1.0)*255+0.5);
+    if (alpha == 0)
+      return;
+    QRgb *pixel = reinterpret_cast<QRgb*>(bits + y*bytesPerLine) + x;
+    const QRgb source = alpha == 255 ? color : byteMul(color, alpha);
+    *pixel = source + byteMul(*pixel, 255-qAlpha(source)); // premultiplied source-over
+  };
+
+  // segments are clipped to the clip rect in pixel center coordinates, i.e. including the half
+  // pixel reaching into the border pixels:
+  const QRectF segmentClipRect(clipRect.left()-0.5, clipRect.top()-0.5, clipRect.width(), clipRect.height());
+  double previousX = 0, previousY = 0;
+  bool hasPrevious = false;
+  bool previousEndDrawn = false; // whether the previous segment was drawn up to the current start point, which then mustn't be blended again
+  for (int i=0; i<pointCount; ++i)
+  {
+    const QPointF &point = points[i];
+    if (qIsNaN(point.x()) || qIsNaN(point.y()) || qIsInf(point.x()) || qIsInf(point.y())) // NaNs create a gap in the line
+    {
+      hasPrevious = false;
+      previousEndDrawn = false;
+      continue;
+    }
+    const QPointF devicePoint = mTransform.map(point);
+    // convert to pixel center coordinates. Non-antialiased lines snap to whole pixels, like QCPPainter::drawLine:
+    const double x = (mAntialiased ? devicePoint.x() : std::floor(devicePoint.x()+0.5))-0.5;
+    const double y = (mAntialiased ? devicePoint.y() : std::floor(devicePoint.y()+0.5))-0.5;
+    if (hasPrevious)
+    {
+      // segments are traced half-open, so the joint of two segments is blended only once:
+      double x0 = previousX, y0 = previousY, x1 = x, y1 = y;
+      if (clipSegment(x0, y0, x1, y1, segmentClipRect))
+      {
+        const bool startClipped = x0 != previousX || y0 != previousY;
+        traceSegment(x0, y0, x1, y1, mAntialiased, previousEndDrawn && !startClipped ? ecSkipStart : ecFull, blendPixel);
+        previousEndDrawn = x1 == x && y1 == y;
+      } else
+        previousEndDrawn = false;
+    }
+    previousX = x;
+    previousY = y;
+    hasPrevious = true;
+  }
+}
+
+/*! \internal
+
+  Clips the line segment from (\a x0, \a y0) to (\a x1, \a y1) to \a clipRect (Liang-Barsky
+  algorithm) and updates the coordinates accordingly. Returns false if the segment lies completely
+  outside of \a clipRect.
+*/
+bool QCPLineRasterizer::clipSegment(double &x0, double &y0, double &x1, double &y1, const QRectF &clipRect)
+{
+  const double dx = x1-x0;
+  const double dy = y1-y0;
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {x0-clipRect.left(), clipRect.right()-x0, y0-clipRect.top(), clipRect.bottom()-y0};
+  double t0 = 0;
+  double t1 = 1;
+  for (int i=0; i<4; ++i)
+  {
+    if (p[i] == 0)
+    {
+      if (q[i] < 0)
+        return false;
+    } else
+    {
+      const double r = q[i]/p[i];
+      if (p[i] < 0)
+      {
+        if (r > t1)
+          return false;
+        if (r > t0)
+          t0 = r;
+      } else
+      {
+        if (r < t0)
+          return false;
+        if (r < t1)
+          t1 = r;
+      }
+    }
+  }
+  // only move clipped end points, so unclipped ones stay exactly equal to the input:
+  const double startX = x0;
+  const double startY = y0;
+  if (t0 > 0)
+  {
+    x0 = startX + t0*dx;
+    y0 = startY + t0*dy;
+  }
+  if (t1 < 1)
+  {
+    x1 = startX + t1*dx;
+    y1 = startY + t1*dy;
+  }
+  return true;
+}
+
+/*! \internal
+
+  Multiplies all four 8 bit channels of \a color with \a alpha (0 to 255). Two channels are
+  processed per integer multiplication, by spreading them over the upper and lower half of a 32 bit
+  word.
+*/
+QRgb QCPLineRasterizer::byteMul(QRgb color, uint alpha)
+{
+  uint redBlue = (color & 0x00ff00ff)*alpha;
+  redBlue = ((redBlue + ((redBlue >> 8) & 0x00ff00ff) + 0x00800080) >> 8) & 0x00ff00ff;
+  uint alphaGreen = ((color >> 8) & 0x00ff00ff)*alpha;
+  alphaGreen = (alphaGreen + ((alphaGreen >> 8) & 0x00ff00ff) + 0x00800080) & 0xff00ff00;
+  return alphaGreen | redBlue;
+}
+/* end of 'src/linerasterizer.cpp' */
@@ -0,0 +1,131 @@
+#pragma once
+#include "src/global.h"
+#include "src/painter.h"
+
+class QCP_LIB_DECL QCPLineRasterizer
+{
+public:
+  /*!
+    Defines how \ref traceSegment covers the end columns of a segment.
+  */
+  enum EndColumns { ecPartial   ///< End columns are covered by the fraction the segment reaches into them, for accumulating coverage
+                   ,ecFull      ///< Both end columns are fully covered
+                   ,ecSkipStart ///< The column of the start point is skipped and the end column is fully covered, for joined polyline segments
+                  };
+  
+  explicit QCPLineRasterizer(QCPPainter *painter);
+
+  // getters:
+  bool isValid() const { return mImage != nullptr; }
+
+  // non-virtual methods:
+  void drawPolyline(const QPointF *points, int pointCount);
+
+  // static methods:
+  static bool clipSegment(double &x0, double &y0, double &x1, double &y1, const QRectF &clipRect);
+  template <class PlotFunction>
+  static void traceSegment(double x0, double y0, double x1, double y1, bool antialiased, EndColumns endColumns, const PlotFunction &plot);
+
+protected:
+  // non-property members:
+  QImage *mImage;
+  QTransform mTransform; // logical to device pixel coordinates
+  QRect mClipRect; // in device pixels
+  QRgb mColor; // premultiplied pen color, including painter opacity
+  bool mAntialiased;
+
+  // non-virtual methods:
+  static QRgb byteMul(QRgb color, uint alpha);
+};
+
+/*! \internal
+
+  Walks the line segment from (\a x0, \a y0) to (\a x1, \a y1) along its major axis, one pixel per
+  step (Xiaolin Wu's algorithm), and calls <tt>plot(x, y, coverage)</tt> for every touched pixel.
+  Coordinates are given in pixels, with integer values at pixel centers. The coverage is the
+  fraction (0 to 1) of the pixel column (or row) that the segment accounts for at pixel (x, y).
+
+  With \a endColumns set to \ref ecPartial, end columns are only partially covered, according to
+  how far the segment reaches into them. This way, a polyline made of many short segments
+  accumulates a coverage of one per column, just like a single long segment would. This is only
+  correct if coverages are added up. When blending, the joint of two segments would be blended
+  twice with half coverage, so the segments of a polyline are rather traced half-open, with \ref
+  ecFull for the first one and \ref ecSkipStart for the following ones. If \a antialiased is true,
+  the coverage of a column is split between the two pixels closest to the ideal line, otherwise it
+  goes to the nearest pixel.
+
+  \a plot is not called for zero coverage, but may be called for pixels outside of any valid
+  image area, so it must do bounds checking itself.
+*/
+template <class PlotFunction>
+void QCPLineRasterizer::traceSegment(double x0, double y0, double x1, double y1, bool antialiased, EndColumns endColumns, const PlotFunction &plot)
+{
+  const bool steep = qAbs(y1-y0) > qAbs(x1-x0);
+  if (steep)
+  {
+    qSwap(x0, y0);
+    qSwap(x1, y1);
+  }
+  bool skipLower = false, skipUpper = false; // whether to skip the lower/upper end column
+  if (x0 > x1)
+  {
+    qSwap(x0, x1);
+    qSwap(y0, y1);
+    skipUpper = endColumns == ecSkipStart;
+  } else
+    skipLower = endColumns == ecSkipStart;
+  // x is now the major axis, plotColumn maps major/minor coordinates back to pixel coordinates:
+  const double gradient = x1 > x0 ? (y1-y0)/(x1-x0) : 0;
+  auto plotColumn = [&](int x, double y, double coverage)
+  {
+    if (coverage <= 0)
+      return;
+    if (antialiased)
+    {
+      const double yFloor = std::floor(y);
+      const int yLow = int(yFloor);
+      const double upperFraction = y-yFloor;
+      if (steep)
+      {
+        plot(yLow, x, (1.0-upperFraction)*coverage);
+        plot(yLow+1, x, upperFraction*coverage);
+      } else
+      {
+        plot(x, yLow, (1.0-upperFraction)*coverage);
+        plot(x, yLow+1, upperFraction*coverage);
+      }
+    } else
+    {
+      const int yNearest = int(std::floor(y+0.5));
+      if (steep)
+        plot(yNearest, x, coverage);
+      else
+        plot(x, yNearest, coverage);
+    }
+  };
+
+  const int xStart = int(std::floor(x0+0.5));
+  const int xEnd = int(std::floor(x1+0.5));
+  if (xStart == xEnd) // segment lies within one column
+  {
+    if (endColumns == ecPartial)
+      plotColumn(xStart, (y0+y1)*0.5, x1-x0);
+    else if (endColumns == ecFull)
+      plotColumn(xStart, (y0+y1)*0.5, 1.0);
+    return;
+  }
+  // end columns:
+  if (!skipLower)
+    plotColumn(xStart, y0+gradient*(xStart-x0), endColumns == ecPartial ? xStart+0.5-x0 : 1.0);
+  if (!skipUpper)
+    plotColumn(xEnd, y0+gradient*(xEnd-x0), endColumns == ecPartial ? x1-(xEnd-0.5) : 1.0);
+  // fully covered inner columns:
+  double y = y0+gradient*(xStart+1-x0);
+  for (int x=xStart+1; x<xEnd; ++x)
+  {
+    plotColumn(x, y, 1.0);
+    y += gradient;
+  }
+}
+
+/* end of 'src/linerasterizer.h' */
@@ -166,7 +166,8 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
   \brief A paint buffer based on QPixmap, using software raster rendering
 
   This paint buffer is the default and fall-back paint buffer which uses software rendering and
-  QPixmap as internal buffer. It is used if \ref QCustomPlot::setOpenGl is false.
+  QPixmap as internal buffer. It is used if \ref QCustomPlot::setOpenGl is false and the plotting
+  hint \ref QCP::phRasterizedLines is not set.
 */
 
 /*!
@@ -229,6 +230,80 @@ void QCPPaintBufferPixmap::reallocateBuffer()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer uses software rendering into a QImage with premultiplied alpha. In contrast to
+  \ref QCPPaintBufferPixmap, the pixels of the buffer are directly accessible while painting, which
+  allows plottables to bypass QPainter for performance critical drawing operations (see \ref
+  QCPLineRasterizer). It is used if \ref QCustomPlot::setOpenGl is false and the plotting hint \ref
+  QCP::phRasterizedLines is set.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+#endif
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
+
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferGlPbuffer
@@ -57,6 +57,26 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage() Q_DECL_OVERRIDE;
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
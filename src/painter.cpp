@@ -212,6 +212,29 @@ void QCPPainter::makeNonCosmetic()
     QPainter::setPen(p);
   }
 }
+
+/*!
+  Draws all \a lines with a single call to QPainter::drawLines. This is significantly faster than
+  calling \ref drawLine for each line separately, since the painter state (pen, transform,
+  clipping) is only evaluated once per batch.
+
+  Like \ref drawLine, this works around the Qt bug of unpredictable QLineF drawing when
+  antialiasing is disabled, by rounding the lines to integer coordinates in that case. The
+  QPainter::drawLines overloads are left untouched and don't round.
+*/
+void QCPPainter::drawLineSegments(const QVector<QLineF> &lines)
+{
+  if (mIsAntialiasing || mModes.testFlag(pmVectorized))
+    QPainter::drawLines(lines);
+  else
+  {
+    mRoundedLineBuffer.resize(lines.size());
+    for (int i=0; i<lines.size(); ++i)
+      mRoundedLineBuffer[i] = lines.at(i).toLine();
+    QPainter::drawLines(mRoundedLineBuffer);
+  }
+}
+
 /* end of 'src/painter.cpp' */
 
 
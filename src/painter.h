@@ -43,6 +43,7 @@ public:
   
   // non-virtual methods:
   void makeNonCosmetic();
+  void drawLineSegments(const QVector<QLineF> &lines);
   
 protected:
   // property members:
@@ -51,6 +52,7 @@ protected:
   
   // non-property members:
   QStack<bool> mAntialiasingStack;
+  QVector<QLine> mRoundedLineBuffer; // reused by drawLineSegments to avoid reallocation for non-antialiased lines
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 Q_DECLARE_METATYPE(QCPPainter::PainterMode)
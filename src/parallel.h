@@ -0,0 +1,88 @@
+#pragma once
+#include "src/global.h"
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QAtomicInt>
+
+/*! \internal
+
+  Shared bookkeeping of one \ref qcpParallelFor call. It is held by a QSharedPointer, so worker
+  tasks that are dequeued by the thread pool only after the call has returned can still safely
+  find out that there is no work left for them.
+*/
+struct QCPParallelForState
+{
+  QCPParallelForState(int begin, int end, int chunkCount) :
+    begin(begin), end(end), chunkCount(chunkCount), nextChunk(0) {}
+
+  int chunkBegin(int chunk) const { return begin + int(qint64(end-begin)*chunk/chunkCount); }
+
+  const int begin, end, chunkCount;
+  QAtomicInt nextChunk;
+  QSemaphore finishedChunks;
+};
+
+template <class Function>
+class QCPParallelForTask : public QRunnable // no QCP_LIB_DECL, template class ends up in header
+{
+public:
+  QCPParallelForTask(const QSharedPointer<QCPParallelForState> &state, const Function *function) :
+    mState(state), mFunction(function) { setAutoDelete(true); }
+
+  virtual void run() Q_DECL_OVERRIDE { processChunks(*mState, *mFunction); }
+
+  static void processChunks(QCPParallelForState &state, const Function &function)
+  {
+    int chunk = state.nextChunk.fetchAndAddOrdered(1);
+    while (chunk < state.chunkCount)
+    {
+      function(state.chunkBegin(chunk), state.chunkBegin(chunk+1));
+      state.finishedChunks.release();
+      chunk = state.nextChunk.fetchAndAddOrdered(1);
+    }
+  }
+
+protected:
+  QSharedPointer<QCPParallelForState> mState;
+  const Function *mFunction; // only dereferenced while chunks are left, i.e. while the calling qcpParallelFor is still waiting
+};
+
+/*! \internal
+
+  Splits the index range [\a begin, \a end) into contiguous chunks of at least \a minChunkSize
+  indices and calls <tt>function(chunkBegin, chunkEnd)</tt> for each chunk. The chunks are
+  distributed over the threads of <tt>QThreadPool::globalInstance()</tt>, and the calling thread
+  takes part in processing them. The function returns once all chunks have been processed.
+
+  If the range is smaller than two chunks or only one thread is available, \a function is simply
+  called once with the full range in the calling thread. Since the calling thread also picks up
+  chunks, the call can't dead-lock even if the thread pool is saturated (e.g. when called from
+  within a pool thread).
+
+  \a function must be safe to call concurrently for disjoint chunks. It is used by the
+  computationally heavy parts of QCustomPlot, e.g. the rasterization in \ref QCPLineDensity.
+*/
+template <class Function>
+inline void qcpParallelFor(int begin, int end, int minChunkSize, const Function &function)
+{
+  const int count = end-begin;
+  if (count <= 0)
+    return;
+  const int maxChunks = QThread::idealThreadCount();
+  const int chunkCount = qMin(maxChunks, count/qMax(1, minChunkSize));
+  if (chunkCount <= 1)
+  {
+    function(begin, end);
+    return;
+  }
+
+  QSharedPointer<QCPParallelForState> state(new QCPParallelForState(begin, end, chunkCount));
+  for (int i=0; i<chunkCount-1; ++i)
+    QThreadPool::globalInstance()->start(new QCPParallelForTask<Function>(state, &function));
+  QCPParallelForTask<Function>::processChunks(*state, function);
+  state->finishedChunks.acquire(chunkCount);
+}
+
+/* end of 'src/parallel.h' */
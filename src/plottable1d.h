@@ -1,6 +1,7 @@
 #pragma once
 #include "src/global.h"
 #include "src/painter.h"
+#include "src/linerasterizer.h"
 #include "src/selection.h"
 #include "src/plottable.h"
 #include "src/core.h"
@@ -21,6 +22,11 @@ public:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const = 0;
   virtual int findBegin(double sortKey, bool expandedRange=true) const = 0;
   virtual int findEnd(double sortKey, bool expandedRange=true) const = 0;
+  
+  // introduced virtual methods:
+  virtual void dataMainKeys(int begin, int end, double *keys) const;
+  virtual void dataMainValues(int begin, int end, double *values) const;
+  virtual void dataPixelPositions(int begin, int end, QPointF *positions) const;
 };
 
 template <class DataType>
@@ -43,6 +49,9 @@ public:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
   virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual void dataMainKeys(int begin, int end, double *keys) const Q_DECL_OVERRIDE;
+  virtual void dataMainValues(int begin, int end, double *values) const Q_DECL_OVERRIDE;
+  virtual void dataPixelPositions(int begin, int end, QPointF *positions) const Q_DECL_OVERRIDE;
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
@@ -52,8 +61,12 @@ protected:
   // property members:
   QSharedPointer<QCPDataContainer<DataType> > mDataContainer;
   
+  // non-property members:
+  mutable QVector<QLineF> mLineSegmentBuffer; // reused by drawPolyline for batched segment drawing
+  
   // helpers for subclasses:
   void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const;
+  void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments, int dataCount) const;
   void drawPolyline(QCPPainter *painter, const QVector<QPointF> &lineData) const;
 
 private:
@@ -71,8 +84,12 @@ private:
 /*! \class QCPPlottableInterface1D
   \brief Defines an abstract interface for one-dimensional plottables
 
-  This class contains only pure virtual methods which define a common interface to the data
-  of one-dimensional plottables.
+  This class contains virtual methods which define a common interface to the data of
+  one-dimensional plottables. Besides the pure virtual methods which access single data points by
+  index, it provides methods which access a whole index range at once (\ref dataMainKeys, \ref
+  dataMainValues and \ref dataPixelPositions). Those have a default implementation based on the
+  single point methods, but implementations may reimplement them to avoid the overhead of one
+  virtual call per data point.
 
   For example, it is implemented by the template class \ref QCPAbstractPlottable1D (the preferred
   base class for one-dimensional plottables). So if you use that template class as base class of
@@ -204,6 +221,62 @@ private:
 
 /* end documentation of pure virtual functions */
 
+/*!
+  Writes the main keys of the data points with indices from \a begin up to (excluding) \a end to
+  the array \a keys, which must have room for at least <tt>end-begin</tt> values. The keys are the
+  same as returned by \ref dataMainKey for the individual indices.
+
+  \a begin and \a end must be valid indices, i.e. <tt>0 <= begin <= end <= dataCount()</tt>.
+
+  The default implementation just calls \ref dataMainKey for each index, implementations of this
+  interface should reimplement it if they can provide the keys more efficiently.
+
+  \see dataMainValues, dataPixelPositions
+*/
+inline void QCPPlottableInterface1D::dataMainKeys(int begin, int end, double *keys) const
+{
+  for (int i=begin; i<end; ++i)
+    *keys++ = dataMainKey(i);
+}
+
+/*!
+  Writes the main values of the data points with indices from \a begin up to (excluding) \a end to
+  the array \a values, which must have room for at least <tt>end-begin</tt> values. The values are
+  the same as returned by \ref dataMainValue for the individual indices.
+
+  \a begin and \a end must be valid indices, i.e. <tt>0 <= begin <= end <= dataCount()</tt>.
+
+  The default implementation just calls \ref dataMainValue for each index, implementations of this
+  interface should reimplement it if they can provide the values more efficiently.
+
+  \see dataMainKeys, dataPixelPositions
+*/
+inline void QCPPlottableInterface1D::dataMainValues(int begin, int end, double *values) const
+{
+  for (int i=begin; i<end; ++i)
+    *values++ = dataMainValue(i);
+}
+
+/*!
+  Writes the pixel positions of the data points with indices from \a begin up to (excluding) \a
+  end to the array \a positions, which must have room for at least <tt>end-begin</tt> points. The
+  positions are the same as returned by \ref dataPixelPosition for the individual indices.
+
+  \a begin and \a end must be valid indices, i.e. <tt>0 <= begin <= end <= dataCount()</tt>.
+
+  Consumers that need the positions of many data points, such as \ref QCPErrorBars, should prefer
+  this method over \ref dataPixelPosition. The default implementation just calls \ref
+  dataPixelPosition for each index, so implementations of this interface should reimplement it if
+  they can provide the positions more efficiently.
+
+  \see dataMainKeys, dataMainValues
+*/
+inline void QCPPlottableInterface1D::dataPixelPositions(int begin, int end, QPointF *positions) const
+{
+  for (int i=begin; i<end; ++i)
+    *positions++ = dataPixelPosition(i);
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPAbstractPlottable1D
@@ -351,6 +424,63 @@ QPointF QCPAbstractPlottable1D<DataType>::dataPixelPosition(int index) const
   }
 }
 
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainKeys
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::dataMainKeys(int begin, int end, double *keys) const
+{
+  if (begin < 0 || end > mDataContainer->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  const typename QCPDataContainer<DataType>::const_iterator itEnd = mDataContainer->constBegin()+end;
+  for (typename QCPDataContainer<DataType>::const_iterator it=mDataContainer->constBegin()+begin; it!=itEnd; ++it)
+    *keys++ = it->mainKey();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainValues
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::dataMainValues(int begin, int end, double *values) const
+{
+  if (begin < 0 || end > mDataContainer->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  const typename QCPDataContainer<DataType>::const_iterator itEnd = mDataContainer->constBegin()+end;
+  for (typename QCPDataContainer<DataType>::const_iterator it=mDataContainer->constBegin()+begin; it!=itEnd; ++it)
+    *values++ = it->mainValue();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataPixelPositions
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::dataPixelPositions(int begin, int end, QPointF *positions) const
+{
+  if (begin < 0 || end > mDataContainer->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const typename QCPDataContainer<DataType>::const_iterator itEnd = mDataContainer->constBegin()+end;
+  for (typename QCPDataContainer<DataType>::const_iterator it=mDataContainer->constBegin()+begin; it!=itEnd; ++it)
+  {
+    const double keyPixel = keyAxis->coordToPixel(it->mainKey());
+    const double valuePixel = valueAxis->coordToPixel(it->mainValue());
+    *positions++ = keyIsHorizontal ? QPointF(keyPixel, valuePixel) : QPointF(valuePixel, keyPixel);
+  }
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::sortKeyIsMainKey
 */
@@ -505,21 +635,33 @@ double QCPAbstractPlottable1D<DataType>::selectTest(const QPointF &pos, bool onl
 */
 template <class DataType>
 void QCPAbstractPlottable1D<DataType>::getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const
+{
+  getDataSegments(selectedSegments, unselectedSegments, dataCount());
+}
+
+/*! \overload
+
+  Splits the index range from 0 to \a dataCount into selected and unselected segments. This is
+  used by subclasses which draw a data container other than \ref data, e.g. an aggregated
+  representation of it (see \ref QCPFinancial::setTimeframes).
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments, int dataCount) const
 {
   selectedSegments.clear();
   unselectedSegments.clear();
   if (mSelectable == QCP::stWhole) // stWhole selection type draws the entire plottable with selected style if mSelection isn't empty
   {
     if (selected())
-      selectedSegments << QCPDataRange(0, dataCount());
+      selectedSegments << QCPDataRange(0, dataCount);
     else
-      unselectedSegments << QCPDataRange(0, dataCount());
+      unselectedSegments << QCPDataRange(0, dataCount);
   } else
   {
     QCPDataSelection sel(selection());
     sel.simplify();
     selectedSegments = sel.dataRanges();
-    unselectedSegments = sel.inverse(QCPDataRange(0, dataCount())).dataRanges();
+    unselectedSegments = sel.inverse(QCPDataRange(0, dataCount)).dataRanges();
   }
 }
 
@@ -548,15 +690,31 @@ void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter *painter, const Q
     painter->setPen(newPen);
   }
 
+  // if drawing thin solid line directly into an image paint buffer, use the software line rasterizer:
+  if (mParentPlot->plottingHints().testFlag(QCP::phRasterizedLines))
+  {
+    QCPLineRasterizer rasterizer(painter);
+    if (rasterizer.isValid())
+    {
+      rasterizer.drawPolyline(lineData.constData(), lineData.size());
+      return;
+    }
+  }
+  
   // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
   if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
       painter->pen().style() == Qt::SolidLine &&
       !painter->modes().testFlag(QCPPainter::pmVectorized) &&
       !painter->modes().testFlag(QCPPainter::pmNoCaching))
   {
+    // collect the non-NaN segments and pass them to the painter in batches, which avoids the
+    // per-call state evaluation overhead of QPainter::drawLine:
+    const int maxBatchSize = 4096; // keeps the segment buffer small for very long lines
     int i = 0;
     bool lastIsNan = false;
     const int lineDataSize = lineData.size();
+    mLineSegmentBuffer.clear();
+    mLineSegmentBuffer.reserve(qMin(lineDataSize, maxBatchSize));
     while (i < lineDataSize && (qIsNaN(lineData.at(i).y()) || qIsNaN(lineData.at(i).x()))) // make sure first point is not NaN
       ++i;
     ++i; // because drawing works in 1 point retrospect
@@ -565,13 +723,22 @@ void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter *painter, const Q
       if (!qIsNaN(lineData.at(i).y()) && !qIsNaN(lineData.at(i).x())) // NaNs create a gap in the line
       {
         if (!lastIsNan)
-          painter->drawLine(lineData.at(i-1), lineData.at(i));
-        else
+        {
+          mLineSegmentBuffer.append(QLineF(lineData.at(i-1), lineData.at(i)));
+          if (mLineSegmentBuffer.size() >= maxBatchSize)
+          {
+            painter->drawLineSegments(mLineSegmentBuffer);
+            mLineSegmentBuffer.clear();
+          }
+        } else
           lastIsNan = false;
       } else
         lastIsNan = true;
       ++i;
     }
+    if (!mLineSegmentBuffer.isEmpty())
+      painter->drawLineSegments(mLineSegmentBuffer);
+    mLineSegmentBuffer.clear();
   } else
   {
     int segmentStart = 0;
@@ -493,7 +493,10 @@ QCPBars::QCPBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mWidthType(wtPlotCoords),
   mBarsGroup(nullptr),
   mBaseValue(0),
-  mStackingGap(1)
+  mStackingGap(1),
+  mAdaptiveSampling(true),
+  mStackedBaseCacheActive(false),
+  mStackedBasesCached(false)
 {
   // modify inherited properties from abstract plottable:
   mPen.setColor(Qt::blue);
@@ -501,6 +504,12 @@ QCPBars::QCPBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mBrush.setColor(QColor(40, 50, 255, 30));
   mBrush.setStyle(Qt::SolidPattern);
   mSelectionDecorator->setBrush(QBrush(QColor(160, 160, 255)));
+  // share the stacked base values of the whole bar stack while the layers of a replot are drawn:
+  if (mParentPlot)
+  {
+    connect(mParentPlot, SIGNAL(afterLayout()), this, SLOT(beginStackedBaseCache()));
+    connect(mParentPlot, SIGNAL(afterReplot()), this, SLOT(endStackedBaseCache()));
+  }
 }
 
 QCPBars::~QCPBars()
@@ -615,6 +624,25 @@ void QCPBars::setStackingGap(double pixels)
   mStackingGap = pixels;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting the bars. This can drastically improve
+  the replot performance for bar charts with more bars than the key axis has pixels, e.g. daily
+  volumes over many years.
+  
+  If enabled and the number of visible bars exceeds the pixel extent of the key axis, bars whose
+  centers fall into the same pixel column are merged into one envelope rectangle, spanning from the
+  lowest base to the highest top of the merged bars. Positive and negative bars are merged
+  separately, and since the envelope is formed from the final bar rects, bar stacking (\ref
+  moveAbove) is respected. The number of drawn rectangles is thus bounded by the axis rect size,
+  independent of the number of bars.
+  
+  By default, adaptive sampling is enabled. It has no effect when the bars are wider than a pixel.
+*/
+void QCPBars::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -839,9 +867,13 @@ QCPRange QCPBars::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
     itBegin = mDataContainer->findBegin(inKeyRange.lower, false);
     itEnd = mDataContainer->findEnd(inKeyRange.upper, false);
   }
+  // calculate stacked base values of the whole range at once, instead of searching the stack per data point:
+  QVector<double> positiveBases, negativeBases;
+  getStackedBaseValues(itBegin, itEnd, positiveBases, negativeBases);
   for (QCPBarsDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
   {
-    const double current = it->value + getStackedBaseValue(it->key, it->value >= 0);
+    const int index = int(it-itBegin);
+    const double current = it->value + (it->value >= 0 ? positiveBases.at(index) : negativeBases.at(index));
     if (qIsNaN(current)) continue;
     if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
     {
@@ -885,6 +917,41 @@ QPointF QCPBars::dataPixelPosition(int index) const
   }
 }
 
+/*!
+  Writes the pixel positions of the bars with indices from \a begin up to (excluding) \a end to
+  \a positions, taking stacking and bars groups into account like \ref dataPixelPosition. The
+  stacked base values of the whole range are determined at once (see \ref getStackedBaseValues),
+  instead of searching the stack for every bar.
+
+  \seebaseclassmethod
+*/
+void QCPBars::dataPixelPositions(int begin, int end, QPointF *positions) const
+{
+  if (begin < 0 || end > mDataContainer->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const QCPBarsDataContainer::const_iterator itBegin = mDataContainer->constBegin()+begin;
+  const QCPBarsDataContainer::const_iterator itEnd = mDataContainer->constBegin()+end;
+  QVector<double> positiveBases, negativeBases;
+  getStackedBaseValues(itBegin, itEnd, positiveBases, negativeBases);
+  
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  int i = 0;
+  for (QCPBarsDataContainer::const_iterator it=itBegin; it!=itEnd; ++it, ++i)
+  {
+    const double base = it->value >= 0 ? positiveBases.at(i) : negativeBases.at(i);
+    const double valuePixel = valueAxis->coordToPixel(base + it->value);
+    const double keyPixel = keyAxis->coordToPixel(it->key) + (mBarsGroup ? mBarsGroup->keyPixelOffset(this, it->key) : 0);
+    *positions++ = keyIsHorizontal ? QPointF(keyPixel, valuePixel) : QPointF(valuePixel, keyPixel);
+  }
+}
+
 /* inherits documentation from base class */
 void QCPBars::draw(QCPPainter *painter)
 {
@@ -894,10 +961,17 @@ void QCPBars::draw(QCPPainter *painter)
   QCPBarsDataContainer::const_iterator visibleBegin, visibleEnd;
   getVisibleDataBounds(visibleBegin, visibleEnd);
   
+  // calculate stacked base values of all visible bars at once, instead of searching the stack per bar:
+  QVector<double> positiveBases, negativeBases;
+  getStackedBaseValues(visibleBegin, visibleEnd, positiveBases, negativeBases);
+  
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
+  QVector<QRectF> barRects;
+  const bool keyIsHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const double keyPixelSpan = qAbs(mKeyAxis.data()->coordToPixel(mKeyAxis.data()->range().upper)-mKeyAxis.data()->coordToPixel(mKeyAxis.data()->range().lower));
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
@@ -907,6 +981,13 @@ void QCPBars::draw(QCPPainter *painter)
     if (begin == end)
       continue;
     
+    // all bars of a segment share the same pen and brush, so collect them and draw them in one call:
+    barRects.clear();
+    barRects.reserve(int(end-begin));
+    const bool aggregate = mAdaptiveSampling && int(end-begin) > keyPixelSpan; // bars narrower than a pixel, merge per pixel column
+    int currentColumn = 0;
+    QRectF positiveEnvelope, negativeEnvelope;
+    bool hasPositiveEnvelope = false, hasNegativeEnvelope = false;
     for (QCPBarsDataContainer::const_iterator it=begin; it!=end; ++it)
     {
       // check data validity if flag set:
@@ -914,19 +995,51 @@ void QCPBars::draw(QCPPainter *painter)
       if (QCP::isInvalidData(it->key, it->value))
         qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "of drawn range invalid." << "Plottable name:" << name();
 #endif
-      // draw bar:
-      if (isSelectedSegment && mSelectionDecorator)
+      const int index = int(it-visibleBegin);
+      const bool positive = it->value >= 0;
+      const QRectF barRect = getBarRect(it->key, it->value, positive ? positiveBases.at(index) : negativeBases.at(index));
+      if (!aggregate)
+      {
+        barRects.append(barRect);
+        continue;
+      }
+      const int column = qFloor(keyIsHorizontal ? barRect.center().x() : barRect.center().y());
+      if (column != currentColumn) // entered new pixel column, emit envelopes of previous one
       {
-        mSelectionDecorator->applyBrush(painter);
-        mSelectionDecorator->applyPen(painter);
+        if (hasPositiveEnvelope)
+          barRects.append(positiveEnvelope);
+        if (hasNegativeEnvelope)
+          barRects.append(negativeEnvelope);
+        hasPositiveEnvelope = false;
+        hasNegativeEnvelope = false;
+        currentColumn = column;
+      }
+      if (positive)
+      {
+        positiveEnvelope = hasPositiveEnvelope ? positiveEnvelope.united(barRect) : barRect;
+        hasPositiveEnvelope = true;
       } else
       {
-        painter->setBrush(mBrush);
-        painter->setPen(mPen);
+        negativeEnvelope = hasNegativeEnvelope ? negativeEnvelope.united(barRect) : barRect;
+        hasNegativeEnvelope = true;
       }
-      applyDefaultAntialiasingHint(painter);
-      painter->drawPolygon(getBarRect(it->key, it->value));
     }
+    if (hasPositiveEnvelope)
+      barRects.append(positiveEnvelope);
+    if (hasNegativeEnvelope)
+      barRects.append(negativeEnvelope);
+    // draw bars:
+    if (isSelectedSegment && mSelectionDecorator)
+    {
+      mSelectionDecorator->applyBrush(painter);
+      mSelectionDecorator->applyPen(painter);
+    } else
+    {
+      painter->setBrush(mBrush);
+      painter->setPen(mPen);
+    }
+    applyDefaultAntialiasingHint(painter);
+    painter->drawRects(barRects);
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -1021,6 +1134,19 @@ void QCPBars::getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin,
   setBaseValue), and to have non-overlapping border lines with the bars stacked below.
 */
 QRectF QCPBars::getBarRect(double key, double value) const
+{
+  return getBarRect(key, value, getStackedBaseValue(key, value >= 0));
+}
+
+/*! \internal
+  
+  \overload
+  
+  Returns the rect in pixel coordinates of a single bar with the specified \a key and \a value,
+  which is stacked on the already known value \a base (see \ref getStackedBaseValue and \ref
+  getStackedBaseValues).
+*/
+QRectF QCPBars::getBarRect(double key, double value, double base) const
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -1028,7 +1154,6 @@ QRectF QCPBars::getBarRect(double key, double value) const
   
   double lowerPixelWidth, upperPixelWidth;
   getPixelWidth(key, lowerPixelWidth, upperPixelWidth);
-  double base = getStackedBaseValue(key, value >= 0);
   double basePixel = valueAxis->coordToPixel(base);
   double valuePixel = valueAxis->coordToPixel(base+value);
   double keyPixel = keyAxis->coordToPixel(key);
@@ -1134,6 +1259,169 @@ double QCPBars::getStackedBaseValue(double key, bool positive) const
     return mBaseValue;
 }
 
+/*! \internal
+  
+  Writes the stacked base values (see \ref getStackedBaseValue) of the bars from \a begin up to
+  (excluding) \a end to \a positiveBases (for positive bars) and \a negativeBases (for negative
+  bars). \a begin and \a end must be iterators of this bars' data container.
+  
+  During a replot, the base values of all data points are calculated only once (see \ref
+  updateStackedBaseCache) and then copied from the cache, so \ref draw, \ref getValueRange and \ref
+  dataPixelPositions don't walk the stack below again. Otherwise they are calculated for the
+  requested range with \ref getStackedBaseValues(const QVector<double> &keys, QVector<double>
+  &positiveBases, QVector<double> &negativeBases) const.
+*/
+void QCPBars::getStackedBaseValues(QCPBarsDataContainer::const_iterator begin, QCPBarsDataContainer::const_iterator end, QVector<double> &positiveBases, QVector<double> &negativeBases) const
+{
+  if (mStackedBaseCacheActive)
+  {
+    updateStackedBaseCache();
+    const int first = int(begin-mDataContainer->constBegin());
+    positiveBases = mStackedPositiveBases.mid(first, int(end-begin));
+    negativeBases = mStackedNegativeBases.mid(first, int(end-begin));
+    return;
+  }
+  QVector<double> keys;
+  keys.reserve(int(end-begin));
+  for (QCPBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+    keys.append(it->key);
+  getStackedBaseValues(keys, positiveBases, negativeBases);
+}
+
+/*! \internal
+  
+  \overload
+  
+  Calculates the stacked base values (see \ref getStackedBaseValue) for all \a keys at once. The
+  results are written to \a positiveBases (for positive bars) and \a negativeBases (for negative
+  bars), which are resized to the size of \a keys.
+  
+  \a keys must be sorted ascendingly, like the keys of a bars data container. Each bars plottable
+  in the stack below is then only searched once and walked in parallel to \a keys, so the cost is
+  linear in the number of keys and bars below, instead of a binary search per key and stack level.
+  
+  If the bars directly below have cached their own base values during a replot, the walk stops
+  there and adds the cached base of the matching bar below, so each stack level is only walked
+  once per replot.
+*/
+void QCPBars::getStackedBaseValues(const QVector<double> &keys, QVector<double> &positiveBases, QVector<double> &negativeBases) const
+{
+  const int keyCount = keys.size();
+  positiveBases.fill(0, keyCount);
+  negativeBases.fill(0, keyCount);
+  if (keyCount == 0)
+    return;
+  
+  const QCPBars *bars = this;
+  while (bars->mBarBelow)
+  {
+    const QCPBars *below = bars->mBarBelow.data();
+    if (below->mStackedBaseCacheActive)
+      below->updateStackedBaseCache();
+    const bool belowCached = below->mStackedBasesCached;
+    const QCPBarsDataContainer::const_iterator itBegin = below->mDataContainer->constBegin();
+    QCPBarsDataContainer::const_iterator it = itBegin;
+    const QCPBarsDataContainer::const_iterator itEnd = below->mDataContainer->constEnd();
+    for (int i=0; i<keyCount; ++i)
+    {
+      // find bars of below that are approximately at key and find largest positive/smallest negative one:
+      const double key = keys.at(i);
+      double epsilon = qAbs(key)*(sizeof(key)==4 ? 1e-6 : 1e-14); // should be safe even when changed to use float at some point
+      if (key == 0)
+        epsilon = (sizeof(key)==4 ? 1e-6 : 1e-14);
+      if (i == 0)
+        it = below->mDataContainer->findBegin(key-epsilon, false);
+      while (it != itEnd && it->key <= key-epsilon) // keys are sorted, so it only ever moves forward
+        ++it;
+      double max = 0, min = 0;
+      bool found = false;
+      for (QCPBarsDataContainer::const_iterator scanIt=it; scanIt != itEnd && scanIt->key < key+epsilon; ++scanIt)
+      {
+        if (scanIt->value > max)
+          max = scanIt->value;
+        else if (scanIt->value < min)
+          min = scanIt->value;
+        found = true;
+      }
+      positiveBases[i] += max;
+      negativeBases[i] += min;
+      if (belowCached)
+      {
+        if (found)
+        {
+          positiveBases[i] += below->mStackedPositiveBases.at(int(it-itBegin));
+          negativeBases[i] += below->mStackedNegativeBases.at(int(it-itBegin));
+        } else // no bar below at this key, so nothing cached for it either
+        {
+          positiveBases[i] += below->getStackedBaseValue(key, true);
+          negativeBases[i] += below->getStackedBaseValue(key, false);
+        }
+      }
+    }
+    if (belowCached) // cached bases already contain everything further down the stack
+      return;
+    bars = below;
+  }
+  // only base value of bottom-most bar has meaning in a bar stack:
+  for (int i=0; i<keyCount; ++i)
+  {
+    positiveBases[i] += bars->mBaseValue;
+    negativeBases[i] += bars->mBaseValue;
+  }
+}
+
+/*! \internal
+  
+  Calculates the stacked base values of all data points of this bars plottable, if they aren't
+  cached yet in the current replot. Since the calculation uses the cached values of the bars below
+  (see \ref getStackedBaseValues), every level of a bars stack is walked only once per replot, no
+  matter how many bars are stacked on top of it.
+  
+  The cache is only used between \ref QCustomPlot::afterLayout and \ref QCustomPlot::afterReplot of
+  a replot (see \ref beginStackedBaseCache), because the data containers may be modified freely
+  at any other time.
+*/
+void QCPBars::updateStackedBaseCache() const
+{
+  if (mStackedBasesCached)
+    return;
+  QVector<double> keys;
+  keys.reserve(mDataContainer->size());
+  for (QCPBarsDataContainer::const_iterator it=mDataContainer->constBegin(); it!=mDataContainer->constEnd(); ++it)
+    keys.append(it->key);
+  getStackedBaseValues(keys, mStackedPositiveBases, mStackedNegativeBases);
+  mStackedBasesCached = true;
+}
+
+/*! \internal
+  
+  Connected to \ref QCustomPlot::afterLayout. Enables the cache of stacked base values (see \ref
+  updateStackedBaseCache) for the layer drawing of a replot, and discards values cached before,
+  since data may have been changed before the replot, e.g. in slots connected to \ref
+  QCustomPlot::beforeReplot.
+  
+  Drawing outside of a replot, like \ref QCustomPlot::toPainter does, also performs the layout
+  but isn't followed by \ref QCustomPlot::afterReplot, so the cache stays disabled there.
+*/
+void QCPBars::beginStackedBaseCache()
+{
+  mStackedBaseCacheActive = mParentPlot && mParentPlot->mReplotting;
+  mStackedBasesCached = false;
+}
+
+/*! \internal
+  
+  Connected to \ref QCustomPlot::afterReplot. Disables and clears the cache of stacked base values
+  (see \ref beginStackedBaseCache).
+*/
+void QCPBars::endStackedBaseCache()
+{
+  mStackedBaseCacheActive = false;
+  mStackedBasesCached = false;
+  mStackedPositiveBases.clear();
+  mStackedNegativeBases.clear();
+}
+
 /*! \internal
 
   Connects \a below and \a above to each other via their mBarAbove/mBarBelow properties. The bar(s)
@@ -108,6 +108,7 @@ class QCP_LIB_DECL QCPBars : public QCPAbstractPlottable1D<QCPBarsData>
   Q_PROPERTY(QCPBarsGroup* barsGroup READ barsGroup WRITE setBarsGroup)
   Q_PROPERTY(double baseValue READ baseValue WRITE setBaseValue)
   Q_PROPERTY(double stackingGap READ stackingGap WRITE setStackingGap)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   Q_PROPERTY(QCPBars* barBelow READ barBelow)
   Q_PROPERTY(QCPBars* barAbove READ barAbove)
   /// \endcond
@@ -133,6 +134,7 @@ public:
   QCPBarsGroup *barsGroup() const { return mBarsGroup; }
   double baseValue() const { return mBaseValue; }
   double stackingGap() const { return mStackingGap; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   QCPBars *barBelow() const { return mBarBelow.data(); }
   QCPBars *barAbove() const { return mBarAbove.data(); }
   QSharedPointer<QCPBarsDataContainer> data() const { return mDataContainer; }
@@ -145,6 +147,7 @@ public:
   void setBarsGroup(QCPBarsGroup *barsGroup);
   void setBaseValue(double baseValue);
   void setStackingGap(double pixels);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -158,6 +161,7 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual void dataPixelPositions(int begin, int end, QPointF *positions) const Q_DECL_OVERRIDE;
   
 protected:
   // property members:
@@ -166,8 +170,14 @@ protected:
   QCPBarsGroup *mBarsGroup;
   double mBaseValue;
   double mStackingGap;
+  bool mAdaptiveSampling;
   QPointer<QCPBars> mBarBelow, mBarAbove;
   
+  // non-property members:
+  bool mStackedBaseCacheActive;
+  mutable bool mStackedBasesCached;
+  mutable QVector<double> mStackedPositiveBases, mStackedNegativeBases;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
@@ -175,8 +185,14 @@ protected:
   // non-virtual methods:
   void getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin, QCPBarsDataContainer::const_iterator &end) const;
   QRectF getBarRect(double key, double value) const;
+  QRectF getBarRect(double key, double value, double base) const;
   void getPixelWidth(double key, double &lower, double &upper) const;
   double getStackedBaseValue(double key, bool positive) const;
+  void getStackedBaseValues(QCPBarsDataContainer::const_iterator begin, QCPBarsDataContainer::const_iterator end, QVector<double> &positiveBases, QVector<double> &negativeBases) const;
+  void getStackedBaseValues(const QVector<double> &keys, QVector<double> &positiveBases, QVector<double> &negativeBases) const;
+  void updateStackedBaseCache() const;
+  Q_SLOT void beginStackedBaseCache();
+  Q_SLOT void endStackedBaseCache();
   static void connectBars(QCPBars* lower, QCPBars* upper);
   
   friend class QCustomPlot;
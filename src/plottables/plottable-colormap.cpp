@@ -2,6 +2,7 @@
 #include "src/painter.h"
 #include "src/core.h"
 #include "src/layoutelements/layoutelement-colorscale.h"
+#include "src/parallel.h"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMapData
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -32,11 +33,21 @@
   that is greater than the current maximum increases this maximum to the new value. However,
   setting the cell that currently holds the maximum value to a smaller value doesn't decrease the
   maximum again, because finding the true new maximum would require going through the entire data
-  array, which might be time consuming. The same holds for the data minimum. This functionality is
-  given by \ref recalculateDataBounds, such that you can decide when it is sensible to find the
-  true current minimum and maximum. The method QCPColorMap::rescaleDataRange offers a convenience
-  parameter \a recalculateDataBounds which may be set to true to automatically call \ref
-  recalculateDataBounds internally.
+  array, which might be time consuming. Instead, the buffered bounds are marked as stale. The same
+  holds for the data minimum. \ref recalculateDataBounds finds the true current minimum and
+  maximum, scanning the data only if the bounds are stale, such that you can decide when it is
+  sensible to do so. The method QCPColorMap::rescaleDataRange offers a convenience parameter \a
+  recalculateDataBounds which may be set to true to automatically call \ref recalculateDataBounds
+  internally.
+  
+  The bounding rect of the cells that were modified (e.g. with \ref setCell or \ref setAlpha) since
+  the color map last displayed the data is tracked as well. This way, the color map only needs to
+  recolorize the affected part of its image. Modifying cells that lie close together, e.g. a
+  single row or column, is thus much cheaper than modifying scattered cells or the whole map.
+  
+  By default, the cells are stored as double values. To reduce the memory footprint of large maps,
+  they can be stored as float or as 8 or 16 bit unsigned integers with a scale and offset instead,
+  see \ref setCellType.
 */
 
 /* start of documentation of inline functions */
@@ -62,9 +73,14 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
   mKeyRange(keyRange),
   mValueRange(valueRange),
   mIsEmpty(true),
+  mCellType(ctDouble),
+  mCellScale(1),
+  mCellOffset(0),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataBoundsStale(false),
+  mDataModified(true),
+  mKeyOrigin(0)
 {
   setSize(keySize, valueSize);
   fill(0);
@@ -83,9 +99,14 @@ QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mKeySize(0),
   mValueSize(0),
   mIsEmpty(true),
+  mCellType(ctDouble),
+  mCellScale(1),
+  mCellOffset(0),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataBoundsStale(false),
+  mDataModified(true),
+  mKeyOrigin(0)
 {
   *this = other;
 }
@@ -102,18 +123,32 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
     const int valueSize = other.valueSize();
     if (!other.mAlpha && mAlpha)
       clearAlpha();
+    if (mCellType != other.mCellType) // cell storage of the other type is reallocated by setSize
+    {
+      delete[] mData;
+      mData = nullptr;
+      mKeySize = 0;
+      mValueSize = 0;
+      mIsEmpty = true;
+      mCellType = other.mCellType;
+    }
+    mCellScale = other.mCellScale;
+    mCellOffset = other.mCellOffset;
     setSize(keySize, valueSize);
     if (other.mAlpha && !mAlpha)
       createAlpha(false);
     setRange(other.keyRange(), other.valueRange());
     if (!isEmpty())
     {
-      memcpy(mData, other.mData, sizeof(mData[0])*size_t(keySize*valueSize));
+      memcpy(mData, other.mData, size_t(cellSize())*size_t(keySize)*size_t(valueSize));
       if (mAlpha)
         memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*size_t(keySize*valueSize));
     }
     mDataBounds = other.mDataBounds;
+    mDataBoundsStale = other.mDataBoundsStale;
+    mKeyOrigin = other.mKeyOrigin; // the data was copied in its physical (ring) order
     mDataModified = true;
+    mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
   }
   return *this;
 }
@@ -124,7 +159,7 @@ double QCPColorMapData::data(double key, double value)
   int keyCell = int( (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5 );
   int valueCell = int( (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5 );
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-    return mData[valueCell*mKeySize + keyCell];
+    return cellValue(qint64(valueCell)*mKeySize + physicalKeyIndex(keyCell));
   else
     return 0;
 }
@@ -133,7 +168,7 @@ double QCPColorMapData::data(double key, double value)
 double QCPColorMapData::cell(int keyIndex, int valueIndex)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mData[valueIndex*mKeySize + keyIndex];
+    return cellValue(qint64(valueIndex)*mKeySize + physicalKeyIndex(keyIndex));
   else
     return 0;
 }
@@ -149,7 +184,7 @@ double QCPColorMapData::cell(int keyIndex, int valueIndex)
 unsigned char QCPColorMapData::alpha(int keyIndex, int valueIndex)
 {
   if (mAlpha && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mAlpha[valueIndex*mKeySize + keyIndex];
+    return mAlpha[valueIndex*mKeySize + physicalKeyIndex(keyIndex)];
   else
     return 255;
 }
@@ -179,7 +214,7 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
 #ifdef __EXCEPTIONS
       try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
 #endif
-      mData = new double[size_t(mKeySize*mValueSize)];
+      mData = new char[size_t(cellSize())*size_t(mKeySize)*size_t(mValueSize)];
 #ifdef __EXCEPTIONS
       } catch (...) { mData = nullptr; }
 #endif
@@ -193,7 +228,9 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
     if (mAlpha) // if we had an alpha map, recreate it with new size
       createAlpha();
     
+    mKeyOrigin = 0;
     mDataModified = true;
+    mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
   }
 }
 
@@ -273,6 +310,65 @@ void QCPColorMapData::setValueRange(const QCPRange &valueRange)
   mValueRange = valueRange;
 }
 
+/*!
+  Sets the data type the cells are stored with to \a type. The existing cell values are converted
+  to the new type.
+  
+  Storing the cells as \ref ctFloat halves the memory and the memory bandwidth needed to colorize
+  the map, compared to the default \ref ctDouble. For data that originates from integers, such as
+  the frames of an 8 or 16 bit camera, \ref ctUInt8 and \ref ctUInt16 reduce it even further. In
+  that case, the integer cell \a i represents the data value <tt>i*scale + offset</tt>, and the
+  color map colorizes the cells with a lookup table of all possible integer values (see \ref
+  QCPColorGradient::lookupTable), instead of mapping each value to the gradient.
+  
+  All methods of this class keep working with data values of type double. When a value is set
+  (e.g. with \ref setCell), it is converted to the cell type. Integer cell types round it to the
+  nearest representable value and clamp it to the value range of the type. They can't represent
+  NaN, which is stored as the integer 0. \a scale and \a offset are ignored for the floating point
+  cell types.
+  
+  Since the conversion may change the cell values, the data bounds are recalculated (see \ref
+  recalculateDataBounds).
+*/
+void QCPColorMapData::setCellType(CellType type, double scale, double offset)
+{
+  if (scale == 0 || !qIsFinite(scale) || !qIsFinite(offset))
+  {
+    qDebug() << Q_FUNC_INFO << "invalid cell scale or offset:" << scale << offset;
+    return;
+  }
+  if (type == ctDouble || type == ctFloat)
+  {
+    scale = 1;
+    offset = 0;
+  }
+  if (type == mCellType && scale == mCellScale && offset == mCellOffset)
+    return;
+  
+  if (!isEmpty())
+  {
+    // convert the cells into the storage of a temporary instance, which then frees the old storage:
+    QCPColorMapData converted(0, 0, mKeyRange, mValueRange);
+    converted.mCellType = type;
+    converted.mCellScale = scale;
+    converted.mCellOffset = offset;
+    converted.setSize(mKeySize, mValueSize);
+    if (!converted.mData)
+      return; // out of memory, setSize already printed a debug message
+    const qint64 dataCount = qint64(mValueSize)*mKeySize;
+    for (qint64 i=0; i<dataCount; ++i)
+      converted.storeCell(i, cellValue(i));
+    qSwap(mData, converted.mData);
+  }
+  mCellType = type;
+  mCellScale = scale;
+  mCellOffset = offset;
+  mDataBoundsStale = true; // the conversion may have changed the minimum and maximum
+  recalculateDataBounds();
+  mDataModified = true;
+  mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
+}
+
 /*!
   Sets the data of the cell, which lies at the plot coordinates given by \a key and \a value, to \a
   z.
@@ -291,12 +387,10 @@ void QCPColorMapData::setData(double key, double value, double z)
   int valueCell = int( (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5 );
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
   {
-    mData[valueCell*mKeySize + keyCell] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
+    const int physicalKeyCell = physicalKeyIndex(keyCell);
+    writeCell(qint64(valueCell)*mKeySize + physicalKeyCell, z);
+    mDataModified = true;
+    mModifiedCells |= QRect(physicalKeyCell, valueCell, 1, 1);
   }
 }
 
@@ -315,12 +409,10 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    mData[valueIndex*mKeySize + keyIndex] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
+    const int physicalKey = physicalKeyIndex(keyIndex);
+    writeCell(qint64(valueIndex)*mKeySize + physicalKey, z);
+    mDataModified = true;
+    mModifiedCells |= QRect(physicalKey, valueIndex, 1, 1);
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
@@ -346,21 +438,221 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
   {
     if (mAlpha || createAlpha())
     {
-      mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
+      const int physicalKey = physicalKeyIndex(keyIndex);
+      mAlpha[valueIndex*mKeySize + physicalKey] = alpha;
       mDataModified = true;
+      mModifiedCells |= QRect(physicalKey, valueIndex, 1, 1);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
 /*!
-  Goes through the data and updates the buffered minimum and maximum data values.
+  Appends a row of \a values at the upper end of the key dimension, for a scrolling waterfall
+  display such as a live spectrogram. \a values must hold \ref valueSize data values, one for
+  each value index. The row at key index 0 (the oldest one) is discarded, and all other rows move
+  down by one key index, so the new row ends up at key index <tt>keySize()-1</tt>.
+
+  If \a shiftKeyRange is true, the key range (\ref setKeyRange) is moved by one cell width, so the
+  rows keep their key coordinates and the map scrolls along the key axis. Otherwise the key range
+  stays and the rows move to smaller key coordinates.
+
+  The rows aren't actually moved in memory. Instead, the rows are organized as a ring with a
+  moving origin, so appending a row only costs as much as writing \a values, and the \ref
+  QCPColorMap only recolorizes the cells of the new row on the next replot. If an alpha map exists,
+  the cells of the new row are made fully opaque.
+*/
+void QCPColorMapData::appendRow(const double *values, bool shiftKeyRange)
+{
+  if (!values)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as values";
+    return;
+  }
+  if (isEmpty())
+    return;
   
-  Calling this method is only advised if you are about to call \ref QCPColorMap::rescaleDataRange
-  and can not guarantee that the cells holding the maximum or minimum data haven't been overwritten
-  with a smaller or larger value respectively, since the buffered maximum/minimum values have been
-  updated the last time. Why this is the case is explained in the class description (\ref
-  QCPColorMapData).
+  const int physicalKey = mKeyOrigin; // the oldest row becomes the newest
+  mKeyOrigin = physicalKeyIndex(1);
+  for (int valueIndex=0; valueIndex<mValueSize; ++valueIndex)
+    writeCell(qint64(valueIndex)*mKeySize + physicalKey, values[valueIndex]);
+  if (mAlpha)
+  {
+    for (int valueIndex=0; valueIndex<mValueSize; ++valueIndex)
+      mAlpha[valueIndex*mKeySize + physicalKey] = 255;
+  }
+  if (shiftKeyRange && mKeySize > 1)
+  {
+    const double cellWidth = (mKeyRange.upper-mKeyRange.lower)/double(mKeySize-1);
+    mKeyRange += cellWidth;
+  }
+  mDataModified = true;
+  mModifiedCells |= QRect(physicalKey, 0, 1, mValueSize);
+}
+
+/*!
+  Bins \a n scattered events into the cells of the map, e.g. to build a two-dimensional histogram.
+  Event \a i lies at the plot coordinates <tt>keys[i]</tt> and <tt>values[i]</tt>, and the cell it
+  falls into is increased by <tt>weights[i]</tt>. If \a weights is \c nullptr, each event increases
+  its cell by one. Events outside of the cells of the map are ignored. The cell of an event is
+  determined like in \ref coordToCell, so the first and last cells are centered on the range
+  boundaries.
+  
+  This is much faster than calling \ref setData for every event, because the coordinate
+  transformation is set up only once. If there are clearly more events than cells, the events are
+  split among several threads (see \ref qcpParallelFor), which bin them into partial histograms of
+  their own. The partial histograms are then added to the cells, again in parallel. The memory of
+  the partial histograms is limited to a few hundred megabytes, so for very large maps, fewer
+  threads are used.
+  
+  The data bounds are expanded by the new values of the changed cells, see \ref
+  recalculateDataBounds.
+*/
+void QCPColorMapData::accumulate(const double *keys, const double *values, const double *weights, int n)
+{
+  if (!keys || !values)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as keys or values";
+    return;
+  }
+  if (isEmpty() || n <= 0)
+    return;
+  
+  const double keyLower = mKeyRange.lower;
+  const double valueLower = mValueRange.lower;
+  const double keyFactor = (mKeySize-1)/(mKeyRange.upper-mKeyRange.lower);
+  const double valueFactor = (mValueSize-1)/(mValueRange.upper-mValueRange.lower);
+  // finds the cell of event i, returns false if it is outside of the map (or has NaN coordinates):
+  auto eventCell = [&](int i, int &keyIndex, int &valueIndex)
+  {
+    const double keyCell = (keys[i]-keyLower)*keyFactor+0.5;
+    const double valueCell = (values[i]-valueLower)*valueFactor+0.5;
+    if (!(keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize))
+      return false;
+    keyIndex = physicalKeyIndex(int(keyCell));
+    valueIndex = int(valueCell);
+    return true;
+  };
+  
+  const qint64 cellCount = qint64(mKeySize)*mValueSize;
+  const qint64 maxPartialCells = 32*1024*1024; // 256 MB of partial histograms
+  const int partialCount = int(qMin(qint64(QThread::idealThreadCount()), qMin(n/qMax(qint64(65536), cellCount), maxPartialCells/cellCount)));
+  QRect touchedCells;
+  if (partialCount <= 1) // few events, or only one thread available
+  {
+    int keyMin = mKeySize, keyMax = -1, valueMin = mValueSize, valueMax = -1;
+    int keyIndex, valueIndex;
+    for (int i=0; i<n; ++i)
+    {
+      if (!eventCell(i, keyIndex, valueIndex))
+        continue;
+      const qint64 index = qint64(valueIndex)*mKeySize + keyIndex;
+      writeCell(index, cellValue(index) + (weights ? weights[i] : 1.0));
+      keyMin = qMin(keyMin, keyIndex);
+      keyMax = qMax(keyMax, keyIndex);
+      valueMin = qMin(valueMin, valueIndex);
+      valueMax = qMax(valueMax, valueIndex);
+    }
+    if (keyMax >= 0)
+      touchedCells = QRect(QPoint(keyMin, valueMin), QPoint(keyMax, valueMax));
+  } else
+  {
+    // bin the events into one partial histogram per thread:
+    QVector<QVector<double> > partials(partialCount);
+    QVector<QRect> partialCells(partialCount);
+    qcpParallelFor(0, partialCount, 1, [&](int chunkBegin, int chunkEnd)
+    {
+      for (int partial=chunkBegin; partial<chunkEnd; ++partial)
+      {
+        QVector<double> &histogram = partials[partial];
+        histogram.resize(int(cellCount)); // zero-initialized
+        double *bins = histogram.data();
+        int keyMin = mKeySize, keyMax = -1, valueMin = mValueSize, valueMax = -1;
+        int keyIndex, valueIndex;
+        const int eventEnd = int(qint64(n)*(partial+1)/partialCount);
+        for (int i=int(qint64(n)*partial/partialCount); i<eventEnd; ++i)
+        {
+          if (!eventCell(i, keyIndex, valueIndex))
+            continue;
+          bins[qint64(valueIndex)*mKeySize + keyIndex] += weights ? weights[i] : 1.0;
+          keyMin = qMin(keyMin, keyIndex);
+          keyMax = qMax(keyMax, keyIndex);
+          valueMin = qMin(valueMin, valueIndex);
+          valueMax = qMax(valueMax, valueIndex);
+        }
+        if (keyMax >= 0)
+          partialCells[partial] = QRect(QPoint(keyMin, valueMin), QPoint(keyMax, valueMax));
+      }
+    });
+    foreach (const QRect &cells, partialCells)
+      touchedCells |= cells;
+    
+    // add the partial histograms to the cells, in parallel over the value rows:
+    if (!touchedCells.isEmpty())
+    {
+      QVector<const double*> bins(partialCount);
+      for (int partial=0; partial<partialCount; ++partial)
+        bins[partial] = partials.at(partial).constData();
+      QVector<QCPRange> rowBounds(mValueSize, QCPRange(std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()));
+      QCPRange *rowBoundsData = rowBounds.data();
+      QVector<char> rowStale(mValueSize, 0); // whether a cell holding the old minimum or maximum was moved inside the bounds
+      char *rowStaleData = rowStale.data();
+      const QCPRange previousBounds = mDataBounds;
+      const int rowCells = touchedCells.width();
+      qcpParallelFor(touchedCells.top(), touchedCells.bottom()+1, qMax(1, 65536/rowCells), [&](int chunkBegin, int chunkEnd)
+      {
+        for (int valueIndex=chunkBegin; valueIndex<chunkEnd; ++valueIndex)
+        {
+          QCPRange &bounds = rowBoundsData[valueIndex];
+          for (int keyIndex=touchedCells.left(); keyIndex<=touchedCells.right(); ++keyIndex)
+          {
+            const qint64 index = qint64(valueIndex)*mKeySize + keyIndex;
+            double sum = 0;
+            for (int partial=0; partial<partialCount; ++partial)
+              sum += bins.at(partial)[index];
+            if (sum == 0)
+              continue;
+            const double previous = cellValue(index);
+            const double z = storeCell(index, previous + sum);
+            if (z < bounds.lower)
+              bounds.lower = z;
+            if (z > bounds.upper)
+              bounds.upper = z;
+            if ((previous == previousBounds.lower && !(z <= previous)) || (previous == previousBounds.upper && !(z >= previous)))
+              rowStaleData[valueIndex] = 1;
+          }
+        }
+      });
+      for (int valueIndex=touchedCells.top(); valueIndex<=touchedCells.bottom(); ++valueIndex)
+      {
+        if (rowBounds.at(valueIndex).lower < mDataBounds.lower)
+          mDataBounds.lower = rowBounds.at(valueIndex).lower;
+        if (rowBounds.at(valueIndex).upper > mDataBounds.upper)
+          mDataBounds.upper = rowBounds.at(valueIndex).upper;
+        if (rowStale.at(valueIndex))
+          mDataBoundsStale = true;
+      }
+    }
+  }
+  if (!touchedCells.isEmpty())
+  {
+    mDataModified = true;
+    mModifiedCells |= touchedCells;
+  }
+}
+
+/*!
+  Updates the buffered minimum and maximum data values, such that they are the true minimum and
+  maximum of the current data. NaN cells are ignored.
+  
+  The data bounds are maintained incrementally while cells are set, see the class description (\ref
+  QCPColorMapData). If no cell holding the buffered minimum or maximum was overwritten since the
+  last update, the buffered bounds are already exact and this method returns immediately. So it is
+  cheap to call this method frequently, e.g. before each \ref QCPColorMap::rescaleDataRange of a
+  live image.
+  
+  Otherwise, all cells are scanned. The scan works on the cells in their stored form and is split
+  among several threads for large maps (see \ref qcpParallelFor).
   
   Note that the method \ref QCPColorMap::rescaleDataRange provides a parameter \a
   recalculateDataBounds for convenience. Setting this to true will call this method for you, before
@@ -368,21 +660,30 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
 */
 void QCPColorMapData::recalculateDataBounds()
 {
-  if (mKeySize > 0 && mValueSize > 0)
+  if (!mDataBoundsStale)
+    return;
+  if (mKeySize > 0 && mValueSize > 0 && mData)
   {
+    // each chunk of rows stores its bounds at the index of its first row:
+    QVector<QCPRange> chunkBounds(mValueSize, QCPRange(std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()));
+    QCPRange *chunkBoundsData = chunkBounds.data();
+    qcpParallelFor(0, mValueSize, qMax(1, 262144/mKeySize), [&](int rowBegin, int rowEnd)
+    {
+      chunkBoundsData[rowBegin] = cellBounds(qint64(rowBegin)*mKeySize, qint64(rowEnd-rowBegin)*mKeySize);
+    });
     double minHeight = std::numeric_limits<double>::max();
     double maxHeight = -std::numeric_limits<double>::max();
-    const int dataCount = mValueSize*mKeySize;
-    for (int i=0; i<dataCount; ++i)
+    for (int row=0; row<mValueSize; ++row)
     {
-      if (mData[i] > maxHeight)
-        maxHeight = mData[i];
-      if (mData[i] < minHeight)
-        minHeight = mData[i];
+      if (chunkBounds.at(row).lower < minHeight)
+        minHeight = chunkBounds.at(row).lower;
+      if (chunkBounds.at(row).upper > maxHeight)
+        maxHeight = chunkBounds.at(row).upper;
     }
     mDataBounds.lower = minHeight;
     mDataBounds.upper = maxHeight;
   }
+  mDataBoundsStale = false;
 }
 
 /*!
@@ -405,6 +706,7 @@ void QCPColorMapData::clearAlpha()
     delete[] mAlpha;
     mAlpha = nullptr;
     mDataModified = true;
+    mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
   }
 }
 
@@ -413,10 +715,24 @@ void QCPColorMapData::clearAlpha()
 */
 void QCPColorMapData::fill(double z)
 {
-  const int dataCount = mValueSize*mKeySize;
-  memset(mData, z, dataCount*sizeof(*mData));
+  const qint64 dataCount = qint64(mValueSize)*mKeySize;
+  if (mData && dataCount > 0)
+  {
+    // store the value in the first cell and replicate it, doubling the filled part with each copy:
+    z = storeCell(0, z);
+    const int size = cellSize();
+    qint64 filledCount = 1;
+    while (filledCount < dataCount)
+    {
+      const qint64 copyCount = qMin(filledCount, dataCount-filledCount);
+      memcpy(mData+filledCount*size, mData, size_t(copyCount*size));
+      filledCount += copyCount;
+    }
+  }
   mDataBounds = QCPRange(z, z);
+  mDataBoundsStale = qIsNaN(z); // NaN bounds can't be expanded, so let recalculateDataBounds replace them
   mDataModified = true;
+  mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
 }
 
 /*!
@@ -435,6 +751,7 @@ void QCPColorMapData::fillAlpha(unsigned char alpha)
     const int dataCount = mValueSize*mKeySize;
     memset(mAlpha, alpha, dataCount*sizeof(*mAlpha));
     mDataModified = true;
+    mModifiedCells = QRect(0, 0, mKeySize, mValueSize);
   }
 }
 
@@ -524,6 +841,231 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   }
 }
 
+/*! \internal
+  
+  Returns the size in bytes of a single cell of the current cell type (see \ref setCellType).
+*/
+int QCPColorMapData::cellSize() const
+{
+  switch (mCellType)
+  {
+  case ctDouble: return int(sizeof(double));
+  case ctFloat: return int(sizeof(float));
+  case ctUInt16: return int(sizeof(quint16));
+  case ctUInt8: return int(sizeof(quint8));
+  }
+  return int(sizeof(double));
+}
+
+/*! \internal
+  
+  Returns the data value of the cell at \a index of the cell storage, converted from the current
+  cell type (see \ref setCellType). \a index is a physical index, i.e. <tt>valueIndex*keySize +
+  physicalKeyIndex(keyIndex)</tt>.
+*/
+double QCPColorMapData::cellValue(qint64 index) const
+{
+  switch (mCellType)
+  {
+  case ctDouble: return reinterpret_cast<const double*>(mData)[index];
+  case ctFloat: return reinterpret_cast<const float*>(mData)[index];
+  case ctUInt16: return reinterpret_cast<const quint16*>(mData)[index]*mCellScale + mCellOffset;
+  case ctUInt8: return reinterpret_cast<const quint8*>(mData)[index]*mCellScale + mCellOffset;
+  }
+  return 0;
+}
+
+/*! \internal
+  
+  Stores the data value \a z in the cell at the physical \a index of the cell storage, converted to
+  the current cell type (see \ref setCellType). Returns the value the cell represents after the
+  conversion, which is used to update the data bounds.
+*/
+double QCPColorMapData::storeCell(qint64 index, double z)
+{
+  switch (mCellType)
+  {
+  case ctDouble:
+  {
+    reinterpret_cast<double*>(mData)[index] = z;
+    return z;
+  }
+  case ctFloat:
+  {
+    const float cell = float(z);
+    reinterpret_cast<float*>(mData)[index] = cell;
+    return cell;
+  }
+  case ctUInt16:
+  {
+    const quint16 cell = quint16(qBound(0.0, std::floor((z-mCellOffset)/mCellScale+0.5), 65535.0)); // qBound maps NaN to 0
+    reinterpret_cast<quint16*>(mData)[index] = cell;
+    return cell*mCellScale + mCellOffset;
+  }
+  case ctUInt8:
+  {
+    const quint8 cell = quint8(qBound(0.0, std::floor((z-mCellOffset)/mCellScale+0.5), 255.0)); // qBound maps NaN to 0
+    reinterpret_cast<quint8*>(mData)[index] = cell;
+    return cell*mCellScale + mCellOffset;
+  }
+  }
+  return z;
+}
+
+/*! \internal
+  
+  Stores the data value \a z in the cell at the physical \a index like \ref storeCell, and keeps the
+  buffered data bounds up to date. Returns the stored value.
+  
+  The bounds are expanded if the stored value lies outside of them. If the cell held the current
+  minimum or maximum and the stored value moves it inside the bounds, the bounds may now be too
+  wide. They are then marked stale, so the next call of \ref recalculateDataBounds rescans the
+  cells.
+*/
+double QCPColorMapData::writeCell(qint64 index, double z)
+{
+  const double previous = cellValue(index);
+  z = storeCell(index, z);
+  if (z < mDataBounds.lower)
+    mDataBounds.lower = z;
+  if (z > mDataBounds.upper)
+    mDataBounds.upper = z;
+  if ((previous == mDataBounds.lower && !(z <= previous)) || (previous == mDataBounds.upper && !(z >= previous))) // also true if z is NaN
+    mDataBoundsStale = true;
+  return z;
+}
+
+/*! \internal
+  
+  Finds the minimum and maximum of the \a count \a cells and returns them in \a lower and \a upper.
+  NaN cells are ignored. If there are no non-NaN cells, \a lower is the largest and \a upper the
+  lowest value of \a T.
+  
+  The loop keeps four independent minima and maxima and uses selects instead of branches. This
+  avoids mispredicted branches and long dependency chains, and lets the compiler use SIMD min/max
+  instructions where the semantics allow it (e.g. for the integer cell types). The comparisons are
+  false for NaN, so the previous minimum or maximum is kept.
+*/
+template <typename T>
+void QCPColorMapData::findCellBounds(const T *cells, qint64 count, T &lower, T &upper)
+{
+  T lowers[4], uppers[4];
+  for (int lane=0; lane<4; ++lane)
+  {
+    lowers[lane] = (std::numeric_limits<T>::max)();
+    uppers[lane] = std::numeric_limits<T>::lowest();
+  }
+  qint64 i = 0;
+  for (; i+4<=count; i+=4)
+  {
+    for (int lane=0; lane<4; ++lane)
+    {
+      const T z = cells[i+lane];
+      lowers[lane] = z < lowers[lane] ? z : lowers[lane];
+      uppers[lane] = z > uppers[lane] ? z : uppers[lane];
+    }
+  }
+  for (; i<count; ++i)
+  {
+    const T z = cells[i];
+    lowers[0] = z < lowers[0] ? z : lowers[0];
+    uppers[0] = z > uppers[0] ? z : uppers[0];
+  }
+  lower = qMin(qMin(lowers[0], lowers[1]), qMin(lowers[2], lowers[3]));
+  upper = qMax(qMax(uppers[0], uppers[1]), qMax(uppers[2], uppers[3]));
+}
+
+/*! \internal
+  
+  Returns the minimum and maximum data value of the \a count cells starting at the physical index
+  \a begin. NaN cells are ignored. If there are no non-NaN cells, the returned range has a lower
+  bound greater than its upper bound.
+  
+  The cells are scanned in their stored form with \ref findCellBounds, and only the result is
+  converted to data values.
+*/
+QCPRange QCPColorMapData::cellBounds(qint64 begin, qint64 count) const
+{
+  QCPRange result(std::numeric_limits<double>::max(), -std::numeric_limits<double>::max());
+  switch (mCellType)
+  {
+  case ctDouble:
+  {
+    double lower, upper;
+    findCellBounds(reinterpret_cast<const double*>(mData)+begin, count, lower, upper);
+    if (lower <= upper)
+      result = QCPRange(lower, upper);
+    break;
+  }
+  case ctFloat:
+  {
+    float lower, upper;
+    findCellBounds(reinterpret_cast<const float*>(mData)+begin, count, lower, upper);
+    if (lower <= upper)
+      result = QCPRange(lower, upper);
+    break;
+  }
+  case ctUInt16:
+  {
+    quint16 lower, upper;
+    findCellBounds(reinterpret_cast<const quint16*>(mData)+begin, count, lower, upper);
+    if (lower <= upper) // a negative scale swaps the roles of lower and upper:
+      result = QCPRange(qMin(lower*mCellScale, upper*mCellScale)+mCellOffset, qMax(lower*mCellScale, upper*mCellScale)+mCellOffset);
+    break;
+  }
+  case ctUInt8:
+  {
+    quint8 lower, upper;
+    findCellBounds(reinterpret_cast<const quint8*>(mData)+begin, count, lower, upper);
+    if (lower <= upper)
+      result = QCPRange(qMin(lower*mCellScale, upper*mCellScale)+mCellOffset, qMax(lower*mCellScale, upper*mCellScale)+mCellOffset);
+    break;
+  }
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Copies the \a n cells at the physical \a indices of the cell storage to \a target, in their
+  stored form, i.e. without conversion from the cell type. \a target must be suitably aligned for
+  the cell type and have room for \a n cells.
+*/
+void QCPColorMapData::gatherCells(const qint64 *indices, int n, char *target) const
+{
+  switch (mCellType)
+  {
+  case ctDouble:
+  {
+    const double *cells = reinterpret_cast<const double*>(mData);
+    for (int i=0; i<n; ++i)
+      reinterpret_cast<double*>(target)[i] = cells[indices[i]];
+    break;
+  }
+  case ctFloat:
+  {
+    const float *cells = reinterpret_cast<const float*>(mData);
+    for (int i=0; i<n; ++i)
+      reinterpret_cast<float*>(target)[i] = cells[indices[i]];
+    break;
+  }
+  case ctUInt16:
+  {
+    const quint16 *cells = reinterpret_cast<const quint16*>(mData);
+    for (int i=0; i<n; ++i)
+      reinterpret_cast<quint16*>(target)[i] = cells[indices[i]];
+    break;
+  }
+  case ctUInt8:
+  {
+    const quint8 *cells = reinterpret_cast<const quint8*>(mData);
+    for (int i=0; i<n; ++i)
+      reinterpret_cast<quint8*>(target)[i] = cells[indices[i]];
+    break;
+  }
+  }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMap
@@ -598,6 +1140,13 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   The newly created plottable can be modified, e.g.:
   \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcolormap-creation-2
   
+  For scrolling displays such as live spectrograms, append new data rows with \ref appendRow. This
+  doesn't shift the existing data in memory, so each new row only costs as much as its own cells.
+  
+  Very large maps, e.g. gigapixel rasters, should enable tiled drawing with \ref setTiled. The map
+  is then colorized lazily in tiles at the resolution needed for the current view, instead of as
+  one image of the full data resolution.
+  
   \note The QCPColorMap always displays the data at equal key/value intervals, even if the key or
   value axis is set to a logarithmic scaling. If you want to use QCPColorMap with logarithmic axes,
   you shouldn't use the \ref QCPColorMapData::setData method as it uses a linear transformation to
@@ -656,7 +1205,16 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mGradient(QCPColorGradient::gpCold),
   mInterpolate(true),
   mTightBoundary(false),
-  mMapImageInvalidated(true)
+  mTiled(false),
+  mTileCacheSize(64),
+  mMapImageInvalidated(true),
+  mTileCache(mTileCacheSize*1024),
+  mTileSize(256),
+  mTileState(-1),
+  mTileKeyOrigin(0),
+  mCellLookupTableScale(1),
+  mCellLookupTableOffset(0),
+  mViewImageState(-1)
 {
 }
 
@@ -778,6 +1336,57 @@ void QCPColorMap::setTightBoundary(bool enabled)
   mTightBoundary = enabled;
 }
 
+/*!
+  Sets whether the color map is drawn from tiles instead of a single image of the full data
+  resolution.
+  
+  If \a enabled is false (the default), the whole map is colorized into one image with one pixel
+  per cell, which is then scaled to the plot. For very large maps, this image may exhaust the
+  available memory, and every redraw scales all of it, even if only a small portion is visible.
+  
+  If \a enabled is true, the map is divided into tiles at several resolution levels. The level
+  with a cell step of 1 holds the full resolution, every following level samples only every second
+  cell of the previous one in both dimensions. When drawing, the level is picked whose resolution
+  is closest to the screen resolution without falling below it, and only the tiles intersecting the
+  visible axis ranges are colorized and drawn. Colorized tiles are kept in a least recently used
+  cache, whose size can be configured with \ref setTileCacheSize. Modified cells (see \ref
+  QCPColorMapData) only cause the tiles containing them to be colorized again.
+  
+  Coarser levels sample one cell per pixel rather than averaging them, like the non-smooth scaling
+  of the full resolution image does. With \ref setInterpolate, the tiles are interpolated across
+  their edges like a single image, since each tile is colorized with a border of its neighbouring
+  cells. Tiled drawing is meant for large, mostly static maps. Appending
+  rows with \ref appendRow moves all cells to new key indices and thus discards all cached tiles.
+*/
+void QCPColorMap::setTiled(bool enabled)
+{
+  if (mTiled != enabled)
+  {
+    mTiled = enabled;
+    // the full resolution map image and the tiles aren't needed at the same time:
+    mMapImage = QImage();
+    mUndersampledMapImage = QImage();
+    mViewImage = QImage();
+    mTileCache.clear();
+    mMapImageInvalidated = true;
+  }
+}
+
+/*!
+  Sets the maximum memory in \a megabytes the colorized tiles may occupy, if tiled drawing is
+  enabled (see \ref setTiled). When the cache is full, the least recently drawn tiles are discarded
+  first.
+  
+  The cache should be large enough to hold all tiles visible at once, otherwise tiles are colorized
+  again on every redraw. With the default of 64 megabytes, this is the case for plots up to around
+  16 megapixels.
+*/
+void QCPColorMap::setTileCacheSize(int megabytes)
+{
+  mTileCacheSize = qMax(0, megabytes);
+  mTileCache.setMaxCost(mTileCacheSize*1024);
+}
+
 /*!
   Associates the color scale \a colorScale with this color map.
   
@@ -831,10 +1440,10 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
   the data that actually lower the maximum of the data set (by overwriting the cell holding the
   current maximum with a smaller value), aren't recognized and the buffered maximum overestimates
   the true maximum of the data set. The same happens for the buffered minimum. To recalculate the
-  true minimum and maximum by explicitly looking at each cell, the method
-  QCPColorMapData::recalculateDataBounds can be used. For convenience, setting the parameter \a
-  recalculateDataBounds calls this method before setting the data range to the buffered minimum and
-  maximum.
+  true minimum and maximum, the method QCPColorMapData::recalculateDataBounds can be used. It only
+  looks at each cell if such an overwrite happened, so it is cheap otherwise. For convenience,
+  setting the parameter \a recalculateDataBounds calls this method before setting the data range
+  to the buffered minimum and maximum.
   
   \see setDataRange
 */
@@ -845,6 +1454,20 @@ void QCPColorMap::rescaleDataRange(bool recalculateDataBounds)
   setDataRange(mMapData->dataBounds());
 }
 
+/*!
+  Appends a row of \a values to the color map data, for a scrolling waterfall display. This is a
+  convenience method equivalent to calling \ref QCPColorMapData::appendRow on \ref data, see
+  there for details.
+
+  Only the cells of the new row are recolorized on the next replot, and the color map image is
+  drawn as two parts with the ring origin of the data in between, so the cost per appended row
+  doesn't depend on the key size of the map.
+*/
+void QCPColorMap::appendRow(const double *values, bool shiftKeyRange)
+{
+  mMapData->appendRow(values, shiftKeyRange);
+}
+
 /*!
   Takes the current appearance of the color map and updates the legend icon, which is used to
   represent this color map in the legend (see \ref QCPLegend).
@@ -861,6 +1484,21 @@ void QCPColorMap::rescaleDataRange(bool recalculateDataBounds)
 */
 void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const QSize &thumbSize)
 {
+  if (mTiled) // colorize only as many cells as the thumbnail needs, instead of the full resolution map image
+  {
+    if (!mMapData->isEmpty() && mKeyAxis && mValueAxis)
+    {
+      bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
+      bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
+      const int step = qMax(1, qMin(mMapData->keySize(), mMapData->valueSize())/qMax(1, 2*qMax(thumbSize.width(), thumbSize.height())));
+      prepareColorization();
+      const QImage thumbImage = colorizeCells(QRect(0, 0, mMapData->keySize(), mMapData->valueSize()), step, mirrorX, mirrorY);
+      if (!thumbImage.isNull())
+        mLegendIcon = QPixmap::fromImage(thumbImage).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    }
+    return;
+  }
+  
   if (mMapImage.isNull() && !data()->isEmpty())
     updateMapImage(); // try to update map image if it's null (happens if no draw has happened yet)
   
@@ -868,7 +1506,31 @@ void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const Q
   {
     bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
     bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
-    mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    QImage orderedImage = mMapImage;
+    const int keyOrigin = mMapData->mKeyOrigin;
+    if (keyOrigin != 0)
+    {
+      // the map image holds the key rows in physical ring order (see QCPColorMapData::appendRow), so
+      // rotate it back to key index order, like draw does by drawing the two parts of the ring:
+      const bool keyIsHorizontal = keyAxis()->orientation() == Qt::Horizontal;
+      const int width = mMapImage.width();
+      const int height = mMapImage.height();
+      orderedImage = QImage(mMapImage.size(), mMapImage.format());
+      QPainter imagePainter(&orderedImage);
+      imagePainter.setCompositionMode(QPainter::CompositionMode_Source);
+      if (keyIsHorizontal)
+      {
+        const int shift = keyOrigin*(width/mMapData->keySize());
+        imagePainter.drawImage(QPoint(0, 0), mMapImage, QRect(shift, 0, width-shift, height));
+        imagePainter.drawImage(QPoint(width-shift, 0), mMapImage, QRect(0, 0, shift, height));
+      } else // image scanlines count from top, but key indices from bottom
+      {
+        const int shift = keyOrigin*(height/mMapData->keySize());
+        imagePainter.drawImage(QPoint(0, shift), mMapImage, QRect(0, 0, width, height-shift));
+        imagePainter.drawImage(QPoint(0, 0), mMapImage, QRect(0, height-shift, width, shift));
+      }
+    }
+    mLegendIcon = QPixmap::fromImage(orderedImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
   }
 }
 
@@ -957,6 +1619,13 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   has been invalidated for a different reason (e.g. a change of the data range with \ref
   setDataRange).
   
+  If only some cells have been modified since the last update (see \ref QCPColorMapData), and the
+  image is otherwise still valid, only the bounding rect of those cells is recolorized. This also
+  applies to the oversampled image.
+  
+  The image lines are colorized in parallel (see \ref qcpParallelFor), if the map is large enough
+  for this to pay off.
+  
   If the map cell count is low, the image created will be oversampled in order to avoid a
   QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
   without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
@@ -973,70 +1642,100 @@ void QCPColorMap::updateMapImage()
   const int valueSize = mMapData->valueSize();
   int keyOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(keySize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   int valueOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(valueSize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
+  const bool oversampling = keyOversamplingFactor > 1 || valueOversamplingFactor > 1;
+  
+  // in image dimensions, a line is a scanline and a row the position within a scanline:
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const int lineCount = keyIsHorizontal ? valueSize : keySize;
+  const int rowCount = keyIsHorizontal ? keySize : valueSize;
+  const int lineOversamplingFactor = keyIsHorizontal ? valueOversamplingFactor : keyOversamplingFactor;
+  const int rowOversamplingFactor = keyIsHorizontal ? keyOversamplingFactor : valueOversamplingFactor;
+  
+  // if the images still have the right dimensions and only some cells changed, only those are recolorized:
+  QRect updateCells(0, 0, keySize, valueSize);
+  const bool imageSizeValid = mMapImage.size() == QSize(rowCount*rowOversamplingFactor, lineCount*lineOversamplingFactor) &&
+                              (!oversampling || mUndersampledMapImage.size() == QSize(rowCount, lineCount));
+  if (imageSizeValid && !mMapImageInvalidated)
+    updateCells &= mMapData->mModifiedCells;
   
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
-  if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
-    mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
-    mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+  if (mMapImage.size() != QSize(rowCount*rowOversamplingFactor, lineCount*lineOversamplingFactor))
+    mMapImage = QImage(QSize(rowCount*rowOversamplingFactor, lineCount*lineOversamplingFactor), format);
   
   if (mMapImage.isNull())
   {
     qDebug() << Q_FUNC_INFO << "Couldn't create map image (possibly too large for memory)";
     mMapImage = QImage(QSize(10, 10), format);
     mMapImage.fill(Qt::black);
-  } else
+  } else if (!updateCells.isEmpty())
   {
     QImage *localMapImage = &mMapImage; // this is the image on which the colorization operates. Either the final mMapImage, or if we need oversampling, mUndersampledMapImage
-    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
+    if (oversampling)
     {
       // resize undersampled map image to actual key/value cell sizes:
-      if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
-        mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
-        mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
+      if (mUndersampledMapImage.size() != QSize(rowCount, lineCount))
+        mUndersampledMapImage = QImage(QSize(rowCount, lineCount), format);
       localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
     } else if (!mUndersampledMapImage.isNull())
       mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
     
-    const double *rawData = mMapData->mData;
+    // the span of lines and of rows within each line that need to be colorized:
+    const int lineBegin = keyIsHorizontal ? updateCells.top() : updateCells.left();
+    const int lineEnd = (keyIsHorizontal ? updateCells.bottom() : updateCells.right())+1;
+    const int rowBegin = keyIsHorizontal ? updateCells.left() : updateCells.top();
+    const int rowEnd = (keyIsHorizontal ? updateCells.right() : updateCells.bottom())+1;
+    
+    const char *rawData = mMapData->mData;
     const unsigned char *rawAlpha = mMapData->mAlpha;
-    if (keyAxis->orientation() == Qt::Horizontal)
+    const int cellSize = mMapData->cellSize();
+    const int lineStride = keyIsHorizontal ? rowCount : 1; // data index offset between the first cells of consecutive lines
+    const int cellStride = keyIsHorizontal ? 1 : lineCount; // data index offset between consecutive cells of a line
+    // the scanlines are independent, so large maps are colorized in parallel. The image is detached
+    // and the colorization state prepared beforehand, so the workers only access shared state for
+    // reading:
+    uchar *imageBits = localMapImage->bits();
+    const int bytesPerLine = localMapImage->bytesPerLine();
+    prepareColorization();
+    const int minCellsPerChunk = 65536; // smaller maps stay serial, the thread handover would cost more than it saves
+    qcpParallelFor(lineBegin, lineEnd, qMax(1, minCellsPerChunk/(rowEnd-rowBegin)), [&](int chunkBegin, int chunkEnd)
     {
-      const int lineCount = valueSize;
-      const int rowCount = keySize;
-      for (int line=0; line<lineCount; ++line)
+      for (int line=chunkBegin; line<chunkEnd; ++line)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
+        QRgb* pixels = reinterpret_cast<QRgb*>(imageBits+qint64(lineCount-1-line)*bytesPerLine)+rowBegin; // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+        const qint64 dataIndex = qint64(line)*lineStride + qint64(rowBegin)*cellStride;
+        colorizeLine(rawData+dataIndex*cellSize, rawAlpha ? rawAlpha+dataIndex : nullptr, cellStride, pixels, rowEnd-rowBegin);
       }
-    } else // keyAxis->orientation() == Qt::Vertical
+    });
+    
+    if (oversampling)
     {
-      const int lineCount = keySize;
-      const int rowCount = valueSize;
-      for (int line=0; line<lineCount; ++line)
+      if (updateCells == QRect(0, 0, keySize, valueSize))
+      {
+        mMapImage = mUndersampledMapImage.scaled(rowCount*rowOversamplingFactor, lineCount*lineOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+      } else
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+        // replicate only the recolorized cells into the oversampled image. With integer factors,
+        // this is identical to the nearest neighbor scaling of QImage::scaled:
+        for (int line=lineBegin; line<lineEnd; ++line)
+        {
+          const QRgb *source = reinterpret_cast<const QRgb*>(mUndersampledMapImage.constScanLine(lineCount-1-line));
+          for (int subLine=0; subLine<lineOversamplingFactor; ++subLine)
+          {
+            QRgb *target = reinterpret_cast<QRgb*>(mMapImage.scanLine((lineCount-1-line)*lineOversamplingFactor+subLine));
+            for (int row=rowBegin; row<rowEnd; ++row)
+            {
+              for (int subRow=0; subRow<rowOversamplingFactor; ++subRow)
+                target[row*rowOversamplingFactor+subRow] = source[row];
+            }
+          }
+        }
       }
     }
-    
-    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
-    {
-      if (keyAxis->orientation() == Qt::Horizontal)
-        mMapImage = mUndersampledMapImage.scaled(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-      else
-        mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-    }
   }
   mMapData->mDataModified = false;
+  mMapData->mModifiedCells = QRect();
   mMapImageInvalidated = false;
+  mViewImage = QImage(); // needs to be resampled from the updated map image
 }
 
 /* inherits documentation from base class */
@@ -1046,7 +1745,7 @@ void QCPColorMap::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) return;
   applyDefaultAntialiasingHint(painter);
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
+  if (!mTiled && (mMapData->mDataModified || mMapImageInvalidated))
     updateMapImage();
   
   // use buffer if painting vectorized (PDF):
@@ -1096,7 +1795,56 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  const int keyOrigin = mMapData->mKeyOrigin;
+  if (mTiled)
+  {
+    drawTiles(localPainter, mirrorX, mirrorY);
+  } else if (!drawViewImage(localPainter, imageRect, mirrorX, mirrorY))
+  {
+    // reversed axes are handled by a mirroring painter transform around the image center instead of a
+    // mirrored copy of the map image, so redrawing doesn't copy the image. The transform is its own
+    // inverse, so a rect that shall end up at a given screen rect is drawn at the transformed rect:
+    QTransform mirrorTransform;
+    if (mirrorX || mirrorY)
+    {
+      mirrorTransform.translate(imageRect.center().x(), imageRect.center().y());
+      mirrorTransform.scale(mirrorX ? -1 : 1, mirrorY ? -1 : 1);
+      mirrorTransform.translate(-imageRect.center().x(), -imageRect.center().y());
+    }
+    localPainter->save();
+    localPainter->setTransform(mirrorTransform, true);
+    if (keyOrigin == 0)
+    {
+      localPainter->drawImage(imageRect, mMapImage);
+    } else
+    {
+      // the key rows of the data form a ring (see QCPColorMapData::appendRow), so the image is drawn
+      // in two parts. The physical key indices [keyOrigin, keySize) hold the key indices [0,
+      // keySize-keyOrigin), and the physical key indices [0, keyOrigin) the remaining ones:
+      const int keySize = mMapData->keySize();
+      const int valueSize = mMapData->valueSize();
+      const QCPRange keyRange = mMapData->keyRange();
+      const QCPRange valueRange = mMapData->valueRange();
+      const double keyStep = keyRange.size()/double(keySize-1); // keyOrigin can only be non-zero if keySize > 1
+      const double halfValueStep = valueSize > 1 ? 0.5*valueRange.size()/double(valueSize-1) : 0;
+      const bool keyIsHorizontal = keyAxis()->orientation() == Qt::Horizontal;
+      const int keyPixelsPerCell = (keyIsHorizontal ? mMapImage.width() : mMapImage.height())/keySize; // oversampling factor in key direction
+      auto drawPart = [&](int keyIndex, int physicalKeyIndex, int count)
+      {
+        const QRectF targetRect = QRectF(coordsToPixels(keyRange.lower+(keyIndex-0.5)*keyStep, valueRange.lower-halfValueStep),
+                                         coordsToPixels(keyRange.lower+(keyIndex+count-0.5)*keyStep, valueRange.upper+halfValueStep)).normalized();
+        QRect sourceRect;
+        if (keyIsHorizontal)
+          sourceRect = QRect(physicalKeyIndex*keyPixelsPerCell, 0, count*keyPixelsPerCell, mMapImage.height());
+        else // image scanlines count from top, but key indices from bottom
+          sourceRect = QRect(0, (keySize-physicalKeyIndex-count)*keyPixelsPerCell, mMapImage.width(), count*keyPixelsPerCell);
+        localPainter->drawImage(mirrorTransform.mapRect(targetRect), mMapImage, sourceRect);
+      };
+      drawPart(0, keyOrigin, keySize-keyOrigin);
+      drawPart(keySize-keyOrigin, 0, keyOrigin);
+    }
+    localPainter->restore();
+  }
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -1108,6 +1856,482 @@ void QCPColorMap::draw(QCPPainter *painter)
   }
 }
 
+/*! \internal
+  
+  Draws the visible part of the map image with \a painter, resampled to the device pixels it
+  covers. \a imageRect is the rect of the full map image in logical pixels, and \a mirrorX and \a
+  mirrorY indicate reversed axes, like in \ref draw.
+  
+  When zoomed into a large map, only a small part of the map image is visible, but drawing the
+  whole image scaled to \a imageRect still makes QPainter transform it as a whole, which is
+  especially expensive with smooth pixmap transformation (see \ref setInterpolate). Instead, the
+  visible cells are resampled here once with a nearest neighbor or (if interpolation is enabled)
+  bilinear kernel, and the result is kept until the map image, the axis ranges or the size of the
+  plot change. Replots that don't change those only copy the resampled image.
+  
+  Returns false if the painter state doesn't allow this, e.g. when painting vectorized or with a
+  rotating transform. \ref draw then draws the full map image as before.
+*/
+bool QCPColorMap::drawViewImage(QCPPainter *painter, const QRectF &imageRect, bool mirrorX, bool mirrorY)
+{
+  if (painter->modes().testFlag(QCPPainter::pmVectorized) || !painter->hasClipping() || mMapImage.isNull())
+    return false;
+  const QTransform deviceTransform = painter->deviceTransform();
+  if (deviceTransform.type() > QTransform::TxScale || deviceTransform.m11() <= 0 || deviceTransform.m22() <= 0)
+    return false;
+  
+  // the visible part of the map, aligned to whole device pixels:
+  const QRectF deviceMapRect = deviceTransform.mapRect(imageRect);
+  const QRect deviceRect = deviceTransform.mapRect(imageRect & painter->clipBoundingRect()).toAlignedRect() & deviceMapRect.toAlignedRect();
+  if (deviceRect.isEmpty())
+    return true;
+  
+  const int viewImageState = (mKeyAxis.data()->orientation() == Qt::Horizontal ? 1 : 0) | (mirrorX ? 2 : 0) | (mirrorY ? 4 : 0);
+  if (mViewImage.isNull() || deviceRect != mViewImageDeviceRect || deviceMapRect != mViewImageMapRect || viewImageState != mViewImageState)
+  {
+    updateViewImage(deviceRect, deviceMapRect, mirrorX, mirrorY);
+    if (mViewImage.isNull())
+      return false;
+    mViewImageDeviceRect = deviceRect;
+    mViewImageMapRect = deviceMapRect;
+    mViewImageState = viewImageState;
+  }
+  
+  // the view image has device resolution, so it is drawn without any scaling of its pixels:
+  const bool smoothBackup = painter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+  painter->drawImage(deviceTransform.inverted().mapRect(QRectF(deviceRect)), mViewImage);
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
+  return true;
+}
+
+/*! \internal
+  
+  Resamples the map image into \ref mViewImage, which covers the device pixels \a deviceRect. \a
+  deviceMapRect is the rect the full map image would cover in device pixels, and \a mirrorX and \a
+  mirrorY indicate reversed axes.
+  
+  Each view pixel samples the map image at the position of its center, with the nearest neighbor
+  kernel, or with a bilinear kernel if interpolation is enabled (see \ref setInterpolate). If the
+  key rows of the data form a ring (see \ref QCPColorMapData::appendRow), the sampled image
+  columns or lines are mapped to their physical position in the map image, so the ring seam is
+  interpolated like any other cell boundary. The view lines are resampled in parallel (see \ref
+  qcpParallelFor) for large views.
+*/
+void QCPColorMap::updateViewImage(const QRect &deviceRect, const QRectF &deviceMapRect, bool mirrorX, bool mirrorY)
+{
+  if (mViewImage.size() != deviceRect.size())
+    mViewImage = QImage(deviceRect.size(), QImage::Format_ARGB32_Premultiplied);
+  if (mViewImage.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create view image (possibly too large for memory)";
+    return;
+  }
+  
+  // the map image rows or scanlines of the ring origin, i.e. of key index 0 (see QCPColorMapData::appendRow):
+  const bool keyIsHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const int imageWidth = mMapImage.width();
+  const int imageHeight = mMapImage.height();
+  const int keyOriginPixels = mMapData->mKeyOrigin*((keyIsHorizontal ? imageWidth : imageHeight)/mMapData->keySize());
+  
+  // for every view column and line, the map image pixels it samples and the (bilinear) weight of the
+  // second pixel, in 1/256:
+  struct Sample { int first, second; uint weight; };
+  auto samples = [this](int viewBegin, int viewCount, double mapBegin, double mapSize, int imageSize, bool mirrored, bool keyDirection, bool keyFromBottom, int originPixels)
+  {
+    QVector<Sample> result(viewCount);
+    auto physicalPixel = [&](int pixel)
+    {
+      pixel = qBound(0, pixel, imageSize-1);
+      if (!keyDirection || originPixels == 0)
+        return pixel;
+      // key indices of the scanlines count from bottom, so the ring origin is applied in that direction:
+      int keyPixel = keyFromBottom ? imageSize-1-pixel : pixel;
+      keyPixel = (keyPixel+originPixels) % imageSize;
+      return keyFromBottom ? imageSize-1-keyPixel : keyPixel;
+    };
+    for (int i=0; i<viewCount; ++i)
+    {
+      double position = (viewBegin+i+0.5-mapBegin)/mapSize*imageSize; // in map image pixels
+      if (mirrored)
+        position = imageSize-position;
+      Sample &sample = result[i];
+      if (mInterpolate)
+      {
+        const double pixel = std::floor(position-0.5);
+        sample.first = physicalPixel(int(qBound(-1.0, pixel, double(imageSize))));
+        sample.second = physicalPixel(int(qBound(-1.0, pixel+1, double(imageSize))));
+        sample.weight = uint(qBound(0.0, (position-0.5-pixel)*256, 256.0));
+      } else
+      {
+        sample.first = physicalPixel(int(qBound(-1.0, std::floor(position), double(imageSize))));
+        sample.second = sample.first;
+        sample.weight = 0;
+      }
+    }
+    return result;
+  };
+  const QVector<Sample> columnSamples = samples(deviceRect.left(), deviceRect.width(), deviceMapRect.left(), deviceMapRect.width(), imageWidth, mirrorX, keyIsHorizontal, false, keyOriginPixels);
+  const QVector<Sample> lineSamples = samples(deviceRect.top(), deviceRect.height(), deviceMapRect.top(), deviceMapRect.height(), imageHeight, mirrorY, !keyIsHorizontal, true, keyOriginPixels);
+  
+  // mixes two premultiplied colors, two channels per integer multiplication:
+  auto mix = [](QRgb first, QRgb second, uint weight)
+  {
+    const uint redBlue = (((first & 0x00ff00ff)*(256-weight) + (second & 0x00ff00ff)*weight) >> 8) & 0x00ff00ff;
+    const uint alphaGreen = (((first >> 8) & 0x00ff00ff)*(256-weight) + ((second >> 8) & 0x00ff00ff)*weight) & 0xff00ff00;
+    return QRgb(alphaGreen | redBlue);
+  };
+  const uchar *imageBits = mMapImage.constBits();
+  const int imageBytesPerLine = mMapImage.bytesPerLine();
+  uchar *viewBits = mViewImage.bits();
+  const int viewBytesPerLine = mViewImage.bytesPerLine();
+  const int viewWidth = mViewImage.width();
+  const Sample *columns = columnSamples.constData();
+  const int minPixelsPerChunk = 65536; // smaller views stay serial, the thread handover would cost more than it saves
+  qcpParallelFor(0, mViewImage.height(), qMax(1, minPixelsPerChunk/viewWidth), [&](int chunkBegin, int chunkEnd)
+  {
+    for (int y=chunkBegin; y<chunkEnd; ++y)
+    {
+      const Sample &line = lineSamples.at(y);
+      const QRgb *firstLine = reinterpret_cast<const QRgb*>(imageBits+qint64(line.first)*imageBytesPerLine);
+      const QRgb *secondLine = reinterpret_cast<const QRgb*>(imageBits+qint64(line.second)*imageBytesPerLine);
+      QRgb *target = reinterpret_cast<QRgb*>(viewBits+qint64(y)*viewBytesPerLine);
+      if (!mInterpolate)
+      {
+        for (int x=0; x<viewWidth; ++x)
+          target[x] = firstLine[columns[x].first];
+      } else
+      {
+        for (int x=0; x<viewWidth; ++x)
+        {
+          const Sample &column = columns[x];
+          target[x] = mix(mix(firstLine[column.first], firstLine[column.second], column.weight),
+                          mix(secondLine[column.first], secondLine[column.second], column.weight), line.weight);
+        }
+      }
+    }
+  });
+}
+
+/*! \internal
+  
+  Draws the visible part of the color map with \a painter, composed of tiles at the resolution
+  level that matches the current screen resolution of the map. This is used by \ref draw instead of
+  the full resolution map image, if tiled drawing is enabled (see \ref setTiled).
+  
+  Tiles that aren't in the tile cache yet are colorized with \ref colorizeCells, in parallel if
+  several tiles are missing (see \ref qcpParallelFor). Tiles colorized for a different axis
+  orientation or mirroring (\a mirrorX, \a mirrorY) are discarded by \ref invalidateTiles.
+*/
+void QCPColorMap::drawTiles(QCPPainter *painter, bool mirrorX, bool mirrorY)
+{
+  prepareColorization(); // before invalidateTiles resets the invalidation state
+  invalidateTiles(mirrorX, mirrorY);
+  
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  const QCPRange keyRange = mMapData->keyRange();
+  const QCPRange valueRange = mMapData->valueRange();
+  const bool keyIsHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  
+  // pick the coarsest resolution level that still has at least one cell per screen pixel:
+  const QPointF lowerPixel = coordsToPixels(keyRange.lower, valueRange.lower);
+  const QPointF upperPixel = coordsToPixels(keyRange.upper, valueRange.upper);
+  const double keyPixels = qAbs(keyIsHorizontal ? upperPixel.x()-lowerPixel.x() : upperPixel.y()-lowerPixel.y());
+  const double valuePixels = qAbs(keyIsHorizontal ? upperPixel.y()-lowerPixel.y() : upperPixel.x()-lowerPixel.x());
+  const double cellsPerPixel = qMin(keySize/qMax(1.0, keyPixels), valueSize/qMax(1.0, valuePixels));
+  int level = 0;
+  while (level < 22 && double(2 << level) <= cellsPerPixel) // level limit keeps the cell count per tile edge within int range
+    ++level;
+  const int step = 1 << level;
+  const int tileCells = mTileSize*step; // cells per tile edge at this level
+  
+  // cell index span that is visible on the axes:
+  auto visibleCells = [](const QCPRange &axisRange, const QCPRange &dataRange, int size, int &begin, int &end)
+  {
+    begin = 0;
+    end = size;
+    if (size < 2)
+      return;
+    double first = (axisRange.lower-dataRange.lower)/(dataRange.upper-dataRange.lower)*(size-1);
+    double last = (axisRange.upper-dataRange.lower)/(dataRange.upper-dataRange.lower)*(size-1);
+    if (!qIsFinite(first) || !qIsFinite(last))
+      return;
+    if (first > last)
+      qSwap(first, last);
+    begin = int(qBound(0.0, std::floor(first+0.5), size-1.0));
+    end = int(qBound(0.0, std::floor(last+0.5), size-1.0))+1;
+  };
+  int keyBegin, keyEnd, valueBegin, valueEnd;
+  visibleCells(mKeyAxis.data()->range(), keyRange, keySize, keyBegin, keyEnd);
+  visibleCells(mValueAxis.data()->range(), valueRange, valueSize, valueBegin, valueEnd);
+  
+  QVector<quint64> tileKeys;
+  QVector<QRect> tileCellRects;
+  QVector<int> missingTiles; // indices into tileKeys of the tiles that need to be colorized
+  for (int tileY=valueBegin/tileCells; tileY<=(valueEnd-1)/tileCells; ++tileY)
+  {
+    for (int tileX=keyBegin/tileCells; tileX<=(keyEnd-1)/tileCells; ++tileX)
+    {
+      const quint64 tileKey = (quint64(level) << 56) | (quint64(tileY) << 28) | quint64(tileX);
+      if (!mTileCache.contains(tileKey))
+        missingTiles.append(tileKeys.size());
+      tileKeys.append(tileKey);
+      tileCellRects.append(QRect(tileX*tileCells, tileY*tileCells, qMin(tileCells, keySize-tileX*tileCells), qMin(tileCells, valueSize-tileY*tileCells)));
+    }
+  }
+  
+  // colorize the missing tiles. They are independent, so this happens in parallel. The colorization
+  // state was prepared beforehand, so the workers only access shared state for reading:
+  QVector<QImage> newTiles(missingTiles.size());
+  QImage *newTileData = newTiles.data();
+  qcpParallelFor(0, missingTiles.size(), 1, [&](int chunkBegin, int chunkEnd)
+  {
+    for (int i=chunkBegin; i<chunkEnd; ++i)
+      newTileData[i] = colorizeCells(tileCellRects.at(missingTiles.at(i)), step, mirrorX, mirrorY, true);
+  });
+  
+  // edges of the cells in plot coordinates, cells are centered on their coordinate (see QCPColorMapData::cellToCoord):
+  auto keyEdge = [&](int index) { return keySize > 1 ? keyRange.lower+(index-0.5)*keyRange.size()/double(keySize-1) : (index == 0 ? keyRange.lower : keyRange.upper); };
+  auto valueEdge = [&](int index) { return valueSize > 1 ? valueRange.lower+(index-0.5)*valueRange.size()/double(valueSize-1) : (index == 0 ? valueRange.lower : valueRange.upper); };
+  int missingIndex = 0;
+  for (int i=0; i<tileKeys.size(); ++i)
+  {
+    const QImage *tile = nullptr;
+    if (missingIndex < missingTiles.size() && missingTiles.at(missingIndex) == i)
+      tile = &newTiles.at(missingIndex++);
+    else
+      tile = mTileCache.object(tileKeys.at(i));
+    if (!tile || tile->isNull())
+      continue;
+    const QRect &cells = tileCellRects.at(i);
+    const QPointF lowerCorner = coordsToPixels(keyEdge(cells.left()), valueEdge(cells.top()));
+    const QPointF upperCorner = coordsToPixels(keyEdge(cells.left()+cells.width()), valueEdge(cells.top()+cells.height()));
+    const QRectF targetRect = QRectF(lowerCorner, upperCorner).normalized();
+    // the tile carries a border of one sample from its neighbours on each side, so interpolation is
+    // continuous across tiles. The image including the border is drawn to the accordingly extended
+    // rect, and clipped to the tile's rect snapped to whole pixels. Neighbouring tiles share the
+    // snapped edges, so they neither overlap nor leave seams:
+    const double borderWidth = targetRect.width()/qMax(1, tile->width()-2);
+    const double borderHeight = targetRect.height()/qMax(1, tile->height()-2);
+    const int clipLeft = qMin(qRound(lowerCorner.x()), qRound(upperCorner.x()));
+    const int clipRight = qMax(qRound(lowerCorner.x()), qRound(upperCorner.x()));
+    const int clipTop = qMin(qRound(lowerCorner.y()), qRound(upperCorner.y()));
+    const int clipBottom = qMax(qRound(lowerCorner.y()), qRound(upperCorner.y()));
+    const QRect clipRect(clipLeft, clipTop, clipRight-clipLeft, clipBottom-clipTop);
+    painter->save();
+    painter->setClipRect(clipRect, Qt::IntersectClip);
+    painter->drawImage(targetRect.adjusted(-borderWidth, -borderHeight, borderWidth, borderHeight), *tile);
+    painter->restore();
+  }
+  
+  // only insert the new tiles after drawing, so they can't evict tiles of this draw call from the cache:
+  for (int i=0; i<missingTiles.size(); ++i)
+  {
+    const QImage &tile = newTiles.at(i);
+    if (!tile.isNull())
+      mTileCache.insert(tileKeys.at(missingTiles.at(i)), new QImage(tile), qMax(1, tile.bytesPerLine()*tile.height()/1024));
+  }
+}
+
+/*! \internal
+  
+  Removes the tiles from the tile cache that no longer represent the current data or appearance of
+  the color map, and resets the modification state of the data, like \ref updateMapImage does for
+  the full resolution map image.
+  
+  All tiles are discarded if the map image was invalidated, the key origin of the data changed (see
+  \ref QCPColorMapData::appendRow), or the tiles were colorized for a different axis orientation or
+  mirroring (\a mirrorX, \a mirrorY). Otherwise, only the tiles containing modified cells are
+  discarded.
+*/
+void QCPColorMap::invalidateTiles(bool mirrorX, bool mirrorY)
+{
+  const int tileState = (mKeyAxis.data()->orientation() == Qt::Horizontal ? 1 : 0) | (mirrorX ? 2 : 0) | (mirrorY ? 4 : 0);
+  if (mMapImageInvalidated || tileState != mTileState || mMapData->mKeyOrigin != mTileKeyOrigin)
+  {
+    mTileCache.clear();
+  } else if (!mMapData->mModifiedCells.isEmpty())
+  {
+    // tiles address cells by key index, but the modified cells are given by physical key index:
+    const int keySize = mMapData->keySize();
+    QRect modifiedCells = mMapData->mModifiedCells;
+    const int keyBegin = (modifiedCells.left()-mMapData->mKeyOrigin+keySize) % keySize;
+    if (keyBegin+modifiedCells.width() <= keySize)
+      modifiedCells.moveLeft(keyBegin);
+    else // modified cells wrap around the key origin
+      modifiedCells = QRect(0, modifiedCells.top(), keySize, modifiedCells.height());
+    foreach (quint64 tileKey, mTileCache.keys())
+    {
+      const int tileCells = mTileSize << int(tileKey >> 56);
+      const QRect cells(int(tileKey & 0xfffffff)*tileCells, int((tileKey >> 28) & 0xfffffff)*tileCells, tileCells, tileCells);
+      if (cells.intersects(modifiedCells))
+        mTileCache.remove(tileKey);
+    }
+  }
+  mTileState = tileState;
+  mTileKeyOrigin = mMapData->mKeyOrigin;
+  mMapData->mDataModified = false;
+  mMapData->mModifiedCells = QRect();
+  mMapImageInvalidated = false;
+}
+
+/*! \internal
+  
+  Colorizes the \a cells (x is the key index and y the value index) into a new image, sampling only
+  every \a step-th cell in both dimensions. The image is oriented like the full resolution map image
+  (see \ref updateMapImage) and already mirrored according to \a mirrorX and \a mirrorY, so it can
+  be drawn directly.
+  
+  Each pixel takes the cell in the middle of the \a step by \a step block of cells it represents.
+  This is used for the tiles of tiled drawing (see \ref setTiled) and the legend icon of tiled color
+  maps.
+  
+  If \a border is true, the image is one pixel larger on each side, holding the neighbouring
+  samples outside of \a cells (or the outermost cells at the map boundary). Tiles use
+  this, so smooth scaling interpolates between neighbouring tiles like within a single image.
+*/
+QImage QCPColorMap::colorizeCells(const QRect &cells, int step, bool mirrorX, bool mirrorY, bool border)
+{
+  const bool keyIsHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const int borderPixels = border ? 1 : 0;
+  const int keyPixels = (cells.width()+step-1)/step+2*borderPixels;
+  const int valuePixels = (cells.height()+step-1)/step+2*borderPixels;
+  QImage image(keyIsHorizontal ? keyPixels : valuePixels, keyIsHorizontal ? valuePixels : keyPixels, QImage::Format_ARGB32_Premultiplied);
+  if (image.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create tile image (possibly too large for memory)";
+    return image;
+  }
+  
+  // the cell index sampled by each image column and scanline. Scanlines count from top, but cell
+  // indices from bottom (mathematical coordinate system), and mirroring is applied right here:
+  auto sampledCells = [step, borderPixels](int begin, int count, int size, int pixelCount, bool reversed)
+  {
+    QVector<int> result(pixelCount);
+    for (int i=0; i<pixelCount; ++i)
+    {
+      const int sample = (reversed ? pixelCount-1-i : i)-borderPixels;
+      if (sample < 0) // leading border, the last sample of the previous tile
+        result[i] = begin >= step ? begin-step+step/2 : qMin(begin+step/2, begin+count-1);
+      else // inner samples, and the trailing border with the first sample of the next tile
+        result[i] = qMin(begin+sample*step+step/2, sample*step < count ? begin+count-1 : size-1);
+    }
+    return result;
+  };
+  QVector<int> keyCells = sampledCells(cells.left(), cells.width(), mMapData->keySize(), keyPixels, keyIsHorizontal ? mirrorX : !mirrorY);
+  const QVector<int> valueCells = sampledCells(cells.top(), cells.height(), mMapData->valueSize(), valuePixels, keyIsHorizontal ? !mirrorY : mirrorX);
+  for (int i=0; i<keyCells.size(); ++i)
+    keyCells[i] = mMapData->physicalKeyIndex(keyCells.at(i));
+  const QVector<int> &columnCells = keyIsHorizontal ? keyCells : valueCells;
+  const QVector<int> &lineCells = keyIsHorizontal ? valueCells : keyCells;
+  
+  // gather the sampled cells of each scanline into a contiguous buffer and colorize it:
+  const qint64 keySize = mMapData->keySize();
+  const unsigned char *rawAlpha = mMapData->mAlpha;
+  QVector<qint64> lineIndexBuffer(image.width());
+  QVector<double> lineCellBuffer(image.width()); // double elements, so the buffer is large enough and aligned for any cell type
+  QVector<unsigned char> lineAlphaBuffer(rawAlpha ? image.width() : 0);
+  qint64 *lineIndices = lineIndexBuffer.data();
+  char *lineCellData = reinterpret_cast<char*>(lineCellBuffer.data());
+  unsigned char *lineAlpha = lineAlphaBuffer.data();
+  for (int y=0; y<image.height(); ++y)
+  {
+    for (int x=0; x<image.width(); ++x)
+      lineIndices[x] = keyIsHorizontal ? lineCells.at(y)*keySize+columnCells.at(x) : columnCells.at(x)*keySize+lineCells.at(y);
+    mMapData->gatherCells(lineIndices, image.width(), lineCellData);
+    if (rawAlpha)
+    {
+      for (int x=0; x<image.width(); ++x)
+        lineAlpha[x] = rawAlpha[lineIndices[x]];
+    }
+    colorizeLine(lineCellData, rawAlpha ? lineAlpha : nullptr, 1, reinterpret_cast<QRgb*>(image.scanLine(y)), image.width());
+  }
+  return image;
+}
+
+/*! \internal
+  
+  Prepares the state that \ref colorizeLine shares between threads, so the actual colorization can
+  run in parallel while only reading it: Updates the color buffer of the gradient (and its level
+  table for logarithmic data scales), and for integer cell types (see \ref
+  QCPColorMapData::setCellType) the lookup table holding the colors of all possible cell values.
+  
+  The lookup table is recreated if the map image was invalidated (e.g. by a change of gradient or
+  data range), or if the cell type, scale or offset of the data changed.
+*/
+void QCPColorMap::prepareColorization()
+{
+  mGradient.color(mDataRange.lower, mDataRange, mDataScaleType == QCPAxis::stLogarithmic);
+  const QCPColorMapData::CellType cellType = mMapData->cellType();
+  if (cellType == QCPColorMapData::ctUInt16 || cellType == QCPColorMapData::ctUInt8)
+  {
+    const int valueCount = cellType == QCPColorMapData::ctUInt16 ? 65536 : 256;
+    if (mMapImageInvalidated || mCellLookupTable.size() != valueCount ||
+        mCellLookupTableScale != mMapData->cellScale() || mCellLookupTableOffset != mMapData->cellOffset())
+    {
+      mCellLookupTable = mGradient.lookupTable(valueCount, mMapData->cellScale(), mMapData->cellOffset(), mDataRange, mDataScaleType == QCPAxis::stLogarithmic);
+      mCellLookupTableScale = mMapData->cellScale();
+      mCellLookupTableOffset = mMapData->cellOffset();
+    }
+  } else if (!mCellLookupTable.isEmpty())
+    mCellLookupTable.clear();
+}
+
+/*! \internal
+  
+  Colorizes \a n cells of the data and writes their colors to \a scanLine. \a cells points to the
+  first cell in the storage format of the data's cell type (see \ref QCPColorMapData::setCellType),
+  and consecutive cells are \a cellStride cells apart. \a alpha is the corresponding part of the
+  alpha map, or \c nullptr if the data has none.
+  
+  Floating point cells are mapped to the gradient directly, integer cells through the lookup table
+  created by \ref prepareColorization, which must have been called before.
+*/
+void QCPColorMap::colorizeLine(const char *cells, const unsigned char *alpha, int cellStride, QRgb *scanLine, int n)
+{
+  const bool logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+  switch (mMapData->cellType())
+  {
+  case QCPColorMapData::ctDouble:
+  {
+    const double *data = reinterpret_cast<const double*>(cells);
+    if (alpha)
+      mGradient.colorize(data, alpha, mDataRange, scanLine, n, cellStride, logarithmic);
+    else
+      mGradient.colorize(data, mDataRange, scanLine, n, cellStride, logarithmic);
+    break;
+  }
+  case QCPColorMapData::ctFloat:
+  {
+    const float *data = reinterpret_cast<const float*>(cells);
+    if (alpha)
+      mGradient.colorize(data, alpha, mDataRange, scanLine, n, cellStride, logarithmic);
+    else
+      mGradient.colorize(data, mDataRange, scanLine, n, cellStride, logarithmic);
+    break;
+  }
+  case QCPColorMapData::ctUInt16:
+  {
+    const quint16 *data = reinterpret_cast<const quint16*>(cells);
+    if (alpha)
+      mGradient.colorize(data, alpha, mCellLookupTable, scanLine, n, cellStride);
+    else
+      mGradient.colorize(data, mCellLookupTable, scanLine, n, cellStride);
+    break;
+  }
+  case QCPColorMapData::ctUInt8:
+  {
+    const quint8 *data = reinterpret_cast<const quint8*>(cells);
+    if (alpha)
+      mGradient.colorize(data, alpha, mCellLookupTable, scanLine, n, cellStride);
+    else
+      mGradient.colorize(data, mCellLookupTable, scanLine, n, cellStride);
+    break;
+  }
+  }
+}
+
 /* inherits documentation from base class */
 void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
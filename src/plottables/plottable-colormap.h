@@ -7,6 +7,17 @@
 class QCP_LIB_DECL QCPColorMapData
 {
 public:
+  /*!
+    Defines the data type the cells are stored with.
+    
+    \see setCellType
+  */
+  enum CellType { ctDouble  ///< 8 byte floating point cells (the default)
+                  ,ctFloat  ///< 4 byte floating point cells
+                  ,ctUInt16 ///< 2 byte unsigned integer cells, representing the data values <tt>cell*scale + offset</tt>
+                  ,ctUInt8  ///< 1 byte unsigned integer cells, representing the data values <tt>cell*scale + offset</tt>
+                };
+  
   QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange);
   ~QCPColorMapData();
   QCPColorMapData(const QCPColorMapData &other);
@@ -18,6 +29,9 @@ public:
   QCPRange keyRange() const { return mKeyRange; }
   QCPRange valueRange() const { return mValueRange; }
   QCPRange dataBounds() const { return mDataBounds; }
+  CellType cellType() const { return mCellType; }
+  double cellScale() const { return mCellScale; }
+  double cellOffset() const { return mCellOffset; }
   double data(double key, double value);
   double cell(int keyIndex, int valueIndex);
   unsigned char alpha(int keyIndex, int valueIndex);
@@ -29,6 +43,7 @@ public:
   void setRange(const QCPRange &keyRange, const QCPRange &valueRange);
   void setKeyRange(const QCPRange &keyRange);
   void setValueRange(const QCPRange &valueRange);
+  void setCellType(CellType type, double scale=1, double offset=0);
   void setData(double key, double value, double z);
   void setCell(int keyIndex, int valueIndex, double z);
   void setAlpha(int keyIndex, int valueIndex, unsigned char alpha);
@@ -39,6 +54,8 @@ public:
   void clearAlpha();
   void fill(double z);
   void fillAlpha(unsigned char alpha);
+  void appendRow(const double *values, bool shiftKeyRange=true);
+  void accumulate(const double *keys, const double *values, const double *weights, int n);
   bool isEmpty() const { return mIsEmpty; }
   void coordToCell(double key, double value, int *keyIndex, int *valueIndex) const;
   void cellToCoord(int keyIndex, int valueIndex, double *key, double *value) const;
@@ -48,16 +65,31 @@ protected:
   int mKeySize, mValueSize;
   QCPRange mKeyRange, mValueRange;
   bool mIsEmpty;
+  CellType mCellType;
+  double mCellScale, mCellOffset;
   
   // non-property members:
-  double *mData;
+  char *mData; // cell storage, holds mKeySize*mValueSize cells of mCellType
   unsigned char *mAlpha;
   QCPRange mDataBounds;
+  bool mDataBoundsStale; // whether a cell holding the minimum or maximum was overwritten, so mDataBounds may be too wide
   bool mDataModified;
+  QRect mModifiedCells; // bounding rect of the cells modified since the last map image update, x is the physical key index and y the value index
+  int mKeyOrigin; // physical key index of the cells with key index 0, non-zero after appendRow
   
   bool createAlpha(bool initializeOpaque=true);
+  int cellSize() const;
+  double cellValue(qint64 index) const;
+  double storeCell(qint64 index, double z);
+  double writeCell(qint64 index, double z);
+  QCPRange cellBounds(qint64 begin, qint64 count) const;
+  template <typename T>
+  static void findCellBounds(const T *cells, qint64 count, T &lower, T &upper);
+  void gatherCells(const qint64 *indices, int n, char *target) const;
+  int physicalKeyIndex(int keyIndex) const { const int index = keyIndex+mKeyOrigin; return index < mKeySize ? index : index-mKeySize; }
   
   friend class QCPColorMap;
+  friend class QCPContour;
 };
 
 
@@ -70,6 +102,8 @@ class QCP_LIB_DECL QCPColorMap : public QCPAbstractPlottable
   Q_PROPERTY(QCPColorGradient gradient READ gradient WRITE setGradient NOTIFY gradientChanged)
   Q_PROPERTY(bool interpolate READ interpolate WRITE setInterpolate)
   Q_PROPERTY(bool tightBoundary READ tightBoundary WRITE setTightBoundary)
+  Q_PROPERTY(bool tiled READ tiled WRITE setTiled)
+  Q_PROPERTY(int tileCacheSize READ tileCacheSize WRITE setTileCacheSize)
   Q_PROPERTY(QCPColorScale* colorScale READ colorScale WRITE setColorScale)
   /// \endcond
 public:
@@ -82,6 +116,8 @@ public:
   QCPAxis::ScaleType dataScaleType() const { return mDataScaleType; }
   bool interpolate() const { return mInterpolate; }
   bool tightBoundary() const { return mTightBoundary; }
+  bool tiled() const { return mTiled; }
+  int tileCacheSize() const { return mTileCacheSize; }
   QCPColorGradient gradient() const { return mGradient; }
   QCPColorScale *colorScale() const { return mColorScale.data(); }
   
@@ -92,10 +128,13 @@ public:
   Q_SLOT void setGradient(const QCPColorGradient &gradient);
   void setInterpolate(bool enabled);
   void setTightBoundary(bool enabled);
+  void setTiled(bool enabled);
+  void setTileCacheSize(int megabytes);
   void setColorScale(QCPColorScale *colorScale);
   
   // non-property methods:
   void rescaleDataRange(bool recalculateDataBounds=false);
+  void appendRow(const double *values, bool shiftKeyRange=true);
   Q_SLOT void updateLegendIcon(Qt::TransformationMode transformMode=Qt::SmoothTransformation, const QSize &thumbSize=QSize(32, 18));
   
   // reimplemented virtual methods:
@@ -116,12 +155,24 @@ protected:
   QCPColorGradient mGradient;
   bool mInterpolate;
   bool mTightBoundary;
+  bool mTiled;
+  int mTileCacheSize;
   QPointer<QCPColorScale> mColorScale;
   
   // non-property members:
   QImage mMapImage, mUndersampledMapImage;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  QCache<quint64, QImage> mTileCache; // colorized tiles, keyed by resolution level and tile indices, cost in kilobytes
+  int mTileSize; // edge length of a tile in pixels, i.e. in sampled cells of its resolution level
+  int mTileState; // axis orientation and mirroring the cached tiles were colorized for
+  int mTileKeyOrigin; // key origin of the data (see QCPColorMapData::appendRow) the cached tiles were colorized for
+  QVector<QRgb> mCellLookupTable; // colors of all integer cell values, for the integer cell types of QCPColorMapData
+  double mCellLookupTableScale, mCellLookupTableOffset; // cell scale and offset the lookup table was created for
+  QImage mViewImage; // visible part of the map image, resampled to device pixels
+  QRect mViewImageDeviceRect; // device pixels covered by mViewImage
+  QRectF mViewImageMapRect; // device rect of the full map image that mViewImage was resampled for
+  int mViewImageState; // axis orientation and mirroring mViewImage was resampled for
   
   // introduced virtual methods:
   virtual void updateMapImage();
@@ -130,6 +181,15 @@ protected:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
+  // non-virtual methods:
+  bool drawViewImage(QCPPainter *painter, const QRectF &imageRect, bool mirrorX, bool mirrorY);
+  void updateViewImage(const QRect &deviceRect, const QRectF &deviceMapRect, bool mirrorX, bool mirrorY);
+  void drawTiles(QCPPainter *painter, bool mirrorX, bool mirrorY);
+  void invalidateTiles(bool mirrorX, bool mirrorY);
+  QImage colorizeCells(const QRect &cells, int step, bool mirrorX, bool mirrorY, bool border=false);
+  void prepareColorization();
+  void colorizeLine(const char *cells, const unsigned char *alpha, int cellStride, QRgb *scanLine, int n);
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
@@ -0,0 +1,539 @@
+#include "src/plottables/plottable-contour.h"
+#include "src/painter.h"
+#include "src/linerasterizer.h"
+#include "src/core.h"
+#include "src/parallel.h"
+#include "src/vector2d.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPContour
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPContour
+  \brief A plottable that draws contour lines (isolines) of a two-dimensional data set
+
+  QCPContour draws the lines along which the cells of a \ref QCPColorMapData take certain values,
+  the contour levels (\ref setLevels). It is typically placed on top of a \ref QCPColorMap showing
+  the same data. The data is accessed via \ref data and has the same layout and coordinate
+  conventions as the data of a color map. To show the contours of an existing color map, pass a
+  copy of its data, e.g. <tt>contour->setData(colorMap->data(), true)</tt>.
+
+  The contour lines are computed with the marching squares algorithm. Every square of four
+  neighboring cells which a level passes through contributes one line segment (or two at saddle
+  points), with the end points linearly interpolated between the cell values. Squares with a NaN
+  cell are skipped, so NaN cells create gaps in the contour lines. The map is split into bands of
+  rows which are processed in parallel (see \ref qcpParallelFor). Each band stitches its segments
+  into polylines, and the polylines of all bands are joined at the band boundaries afterwards.
+
+  The resulting polylines are cached until the data or the levels change, so replots with changed
+  axis ranges only need to transform the cached lines to pixel coordinates. All lines of a level
+  are drawn with one batched call. The lines are drawn with the pen of the plottable (\ref
+  setPen).
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPColorMapData *QCPContour::data() const
+
+  Returns a pointer to the internal data storage of type \ref QCPColorMapData. Access this to
+  modify data points (cells) and the contour's data dimensions. Changing the data causes the
+  contour lines to be recomputed on the next replot.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a contour plottable with the specified \a keyAxis and \a valueAxis.
+
+  The created QCPContour is automatically registered with the QCustomPlot instance inferred from
+  \a keyAxis. This QCustomPlot instance takes ownership of the QCPContour, so do not delete it
+  manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPContour::QCPContour(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mMapData(new QCPColorMapData(10, 10, QCPRange(0, 5), QCPRange(0, 5))),
+  mContoursInvalidated(true)
+{
+}
+
+QCPContour::~QCPContour()
+{
+  delete mMapData;
+}
+
+/*!
+  Replaces the current \ref data with the provided \a data.
+
+  If \a copy is set to true, the \a data object will only be copied. if false, the contour plottable
+  takes ownership of the passed data and replaces the internal data pointer with it. This is
+  significantly faster than copying for large datasets.
+*/
+void QCPContour::setData(QCPColorMapData *data, bool copy)
+{
+  if (mMapData == data)
+  {
+    qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
+    return;
+  }
+  if (copy)
+  {
+    *mMapData = *data;
+  } else
+  {
+    delete mMapData;
+    mMapData = data;
+  }
+  mContoursInvalidated = true;
+}
+
+/*!
+  Sets the data values at which contour lines are drawn. The levels are sorted in ascending order,
+  NaN levels are removed.
+
+  \see setEquidistantLevels
+*/
+void QCPContour::setLevels(const QVector<double> &levels)
+{
+  QVector<double> sortedLevels;
+  sortedLevels.reserve(levels.size());
+  for (int i=0; i<levels.size(); ++i)
+  {
+    if (!qIsNaN(levels.at(i)))
+      sortedLevels.append(levels.at(i));
+  }
+  std::sort(sortedLevels.begin(), sortedLevels.end());
+  if (sortedLevels != mLevels)
+  {
+    mLevels = sortedLevels;
+    mContoursInvalidated = true;
+  }
+}
+
+/*!
+  Sets \a levelCount contour levels which divide the current data bounds (\ref
+  QCPColorMapData::dataBounds) into \a levelCount equally sized intervals, with each level at the
+  center of its interval.
+
+  \see setLevels
+*/
+void QCPContour::setEquidistantLevels(int levelCount)
+{
+  const QCPRange bounds = mMapData->dataBounds();
+  QVector<double> levels;
+  levels.reserve(qMax(0, levelCount));
+  for (int i=0; i<levelCount; ++i)
+    levels.append(bounds.lower + (i+0.5)*bounds.size()/levelCount);
+  setLevels(levels);
+}
+
+/*!
+  Implements a selectTest specific to this plottable's line geometry. The contour lines of the
+  last replot are used, the returned value is the pixel distance of \a pos to the closest line.
+
+  \seebaseclassmethod \ref QCPAbstractPlottable::selectTest
+*/
+double QCPContour::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  if ((onlySelectable && mSelectable == QCP::stNone) || mMapData->isEmpty() || mContoursInvalidated)
+    return -1;
+  if (!mKeyAxis || !mValueAxis || mMapData->keySize() < 2 || mMapData->valueSize() < 2)
+    return -1;
+
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()) || mParentPlot->interactions().testFlag(QCP::iSelectPlottablesBeyondAxisRect))
+  {
+    const QCPRange keyRange = mMapData->keyRange();
+    const QCPRange valueRange = mMapData->valueRange();
+    const double keyStep = (keyRange.upper-keyRange.lower)/(mMapData->keySize()-1);
+    const double valueStep = (valueRange.upper-valueRange.lower)/(mMapData->valueSize()-1);
+    const QCPVector2D posVector(pos);
+    double minDistSqr = (std::numeric_limits<double>::max)();
+    for (int level=0; level<mContourLines.size(); ++level)
+    {
+      const QVector<QVector<QPointF> > &polylines = mContourLines.at(level);
+      for (int i=0; i<polylines.size(); ++i)
+      {
+        const QVector<QPointF> &points = polylines.at(i);
+        QCPVector2D previous(coordsToPixels(keyRange.lower+points.first().x()*keyStep, valueRange.lower+points.first().y()*valueStep));
+        for (int p=1; p<points.size(); ++p)
+        {
+          const QCPVector2D current(coordsToPixels(keyRange.lower+points.at(p).x()*keyStep, valueRange.lower+points.at(p).y()*valueStep));
+          const double distSqr = posVector.distanceSquaredToLine(previous, current);
+          if (distSqr < minDistSqr)
+            minDistSqr = distSqr;
+          previous = current;
+        }
+      }
+    }
+    if (minDistSqr == (std::numeric_limits<double>::max)())
+      return -1;
+    if (details)
+      details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, like QCPColorMap
+    return qSqrt(minDistSqr);
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPContour::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  foundRange = true;
+  QCPRange result = mMapData->keyRange();
+  result.normalize();
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPContour::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (inKeyRange != QCPRange())
+  {
+    if (mMapData->keyRange().upper < inKeyRange.lower || mMapData->keyRange().lower > inKeyRange.upper)
+    {
+      foundRange = false;
+      return {};
+    }
+  }
+
+  foundRange = true;
+  QCPRange result = mMapData->valueRange();
+  result.normalize();
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPContour::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mMapData->isEmpty() || mLevels.isEmpty()) return;
+  if (mContoursInvalidated || mMapData->mDataModified)
+    updateContours();
+  if (mMapData->keySize() < 2 || mMapData->valueSize() < 2) return;
+
+  applyDefaultAntialiasingHint(painter);
+  if (selected() && mSelectionDecorator)
+    mSelectionDecorator->applyPen(painter);
+  else
+    painter->setPen(mPen);
+  painter->setBrush(Qt::NoBrush);
+  // reduce 1px lines to cosmetic, like QCPAbstractPlottable1D::drawPolyline:
+  if (!painter->modes().testFlag(QCPPainter::pmVectorized) && qFuzzyCompare(painter->pen().widthF(), 1.0))
+  {
+    QPen newPen = painter->pen();
+    newPen.setWidth(0);
+    painter->setPen(newPen);
+  }
+
+  // the cached lines are in cell index coordinates, transform them to pixels and draw each level in one go:
+  const QCPRange keyRange = mMapData->keyRange();
+  const QCPRange valueRange = mMapData->valueRange();
+  const double keyStep = (keyRange.upper-keyRange.lower)/(mMapData->keySize()-1);
+  const double valueStep = (valueRange.upper-valueRange.lower)/(mMapData->valueSize()-1);
+  QVector<QPointF> lineData;
+  for (int level=0; level<mContourLines.size(); ++level)
+  {
+    const QVector<QVector<QPointF> > &polylines = mContourLines.at(level);
+    lineData.clear();
+    for (int i=0; i<polylines.size(); ++i)
+    {
+      if (!lineData.isEmpty())
+        lineData.append(QPointF(qQNaN(), qQNaN())); // gap between polylines
+      const QVector<QPointF> &points = polylines.at(i);
+      for (int p=0; p<points.size(); ++p)
+        lineData.append(coordsToPixels(keyRange.lower+points.at(p).x()*keyStep, valueRange.lower+points.at(p).y()*valueStep));
+    }
+    if (!lineData.isEmpty())
+      drawContourLines(painter, lineData);
+  }
+}
+
+/* inherits documentation from base class */
+void QCPContour::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(mPen);
+  painter->setBrush(Qt::NoBrush);
+  const QPointF center = rect.center();
+  painter->drawEllipse(center, rect.width()*0.45, rect.height()*0.45);
+  painter->drawEllipse(center, rect.width()*0.2, rect.height()*0.2);
+}
+
+/*! \internal
+
+  Recomputes the cached contour lines of all levels from the current data and resets the data's
+  modification state.
+
+  The rows of squares are split into one band per CPU core. The bands are traced in parallel (\ref
+  traceBand) and each band stitches its segments into polylines. Finally, the polylines of all
+  bands are joined at the band boundaries, in parallel over the levels.
+*/
+void QCPContour::updateContours()
+{
+  mContoursInvalidated = false;
+  mMapData->mDataModified = false;
+  mMapData->mModifiedCells = QRect();
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  const int levelCount = mLevels.size();
+  mContourLines.clear();
+  mContourLines.resize(levelCount);
+  if (mMapData->isEmpty() || keySize < 2 || valueSize < 2 || levelCount == 0)
+    return;
+
+  const int squareRows = valueSize-1;
+  const int minBandRows = qMax(1, 16384/keySize);
+  const int bandCount = qMax(1, qMin(QThread::idealThreadCount(), squareRows/minBandRows));
+  QVector<QVector<QVector<Piece> > > bandChains(bandCount); // per band and level
+  QVector<QVector<Piece> > *bandChainsData = bandChains.data(); // raw access, so worker threads don't touch the outer vector's implicit sharing
+  qcpParallelFor(0, bandCount, 1, [&](int bandBegin, int bandEnd)
+  {
+    for (int band=bandBegin; band<bandEnd; ++band)
+    {
+      QVector<QVector<Piece> > &levelChains = bandChainsData[band];
+      traceBand(int(qint64(squareRows)*band/bandCount), int(qint64(squareRows)*(band+1)/bandCount), levelChains);
+      for (int level=0; level<levelCount; ++level)
+        levelChains[level] = stitchPieces(levelChains.at(level));
+    }
+  });
+
+  QVector<QVector<QPointF> > *contourLines = mContourLines.data();
+  qcpParallelFor(0, levelCount, 1, [&](int levelBegin, int levelEnd)
+  {
+    for (int level=levelBegin; level<levelEnd; ++level)
+    {
+      QVector<Piece> chains;
+      for (int band=0; band<bandCount; ++band)
+        chains += bandChainsData[band].at(level);
+      if (bandCount > 1)
+        chains = stitchPieces(chains);
+      contourLines[level].reserve(chains.size());
+      for (int i=0; i<chains.size(); ++i)
+        contourLines[level].append(chains.at(i).points);
+    }
+  });
+}
+
+/*! \internal
+
+  Runs marching squares on the rows of squares from \a valueBegin to \a valueEnd (exclusive), where
+  the square at value index \a v spans the cell rows \a v and <tt>v+1</tt>. The segments of each
+  level are returned as two-point pieces in \a levelSegments, which is resized to the number of
+  levels.
+
+  Segment end points lie on the grid edges between neighboring cells. They are identified by
+  <tt>(valueIndex*keySize + keyIndex)*2</tt> for the edge from cell (keyIndex, valueIndex) to its
+  key neighbor, plus one for the edge to its value neighbor. Since the crossing point of an edge is
+  computed with the same operands in both squares sharing it, the points of joined pieces match
+  exactly.
+
+  This method is called concurrently for different bands, so it may only read the state of this
+  plottable.
+*/
+void QCPContour::traceBand(int valueBegin, int valueEnd, QVector<QVector<Piece> > &levelSegments) const
+{
+  // edge pairs of the segments for each corner configuration. Corners are numbered
+  // counterclockwise starting at the lowest key and value, bit i of the configuration is set if
+  // corner i is at or above the level. Edge i connects corner i and corner i+1 (modulo 4):
+  static const int segmentEdges[16][4] = {{-1, -1, -1, -1}, {3, 0, -1, -1}, {0, 1, -1, -1}, {3, 1, -1, -1},
+                                          {1, 2, -1, -1}, {3, 0, 1, 2}, {0, 2, -1, -1}, {2, 3, -1, -1},
+                                          {2, 3, -1, -1}, {0, 2, -1, -1}, {0, 1, 2, 3}, {1, 2, -1, -1},
+                                          {3, 1, -1, -1}, {0, 1, -1, -1}, {3, 0, -1, -1}, {-1, -1, -1, -1}};
+  const int keySize = mMapData->keySize();
+  const int levelCount = mLevels.size();
+  const double *levelsBegin = mLevels.constData();
+  const double *levelsEnd = levelsBegin+levelCount;
+  levelSegments.clear();
+  levelSegments.resize(levelCount);
+
+  QVector<double> lowerRow(keySize), upperRow(keySize);
+  auto gatherRow = [this, keySize](int valueIndex, double *row)
+  {
+    const qint64 rowIndex = qint64(valueIndex)*keySize;
+    for (int keyIndex=0; keyIndex<keySize; ++keyIndex)
+      row[keyIndex] = mMapData->cellValue(rowIndex + mMapData->physicalKeyIndex(keyIndex));
+  };
+  gatherRow(valueBegin, lowerRow.data());
+  for (int v=valueBegin; v<valueEnd; ++v)
+  {
+    gatherRow(v+1, upperRow.data());
+    const double *lower = lowerRow.constData();
+    const double *upper = upperRow.constData();
+    for (int k=0; k<keySize-1; ++k)
+    {
+      const double z[4] = {lower[k], lower[k+1], upper[k+1], upper[k]};
+      if (qIsNaN(z[0]) || qIsNaN(z[1]) || qIsNaN(z[2]) || qIsNaN(z[3]))
+        continue;
+      const double zMin = qMin(qMin(z[0], z[1]), qMin(z[2], z[3]));
+      const double zMax = qMax(qMax(z[0], z[1]), qMax(z[2], z[3]));
+      // only levels with zMin < level <= zMax cross this square:
+      for (const double *levelIt=std::upper_bound(levelsBegin, levelsEnd, zMin); levelIt!=levelsEnd && *levelIt<=zMax; ++levelIt)
+      {
+        const double level = *levelIt;
+        int configuration = (z[0] >= level ? 1 : 0) | (z[1] >= level ? 2 : 0) | (z[2] >= level ? 4 : 0) | (z[3] >= level ? 8 : 0);
+        if ((configuration == 5 || configuration == 10) && (z[0]+z[1]+z[2]+z[3])*0.25 >= level) // saddle with connected upper corners
+          configuration = 15-configuration;
+        const int *edges = segmentEdges[configuration];
+        QVector<Piece> &target = levelSegments[int(levelIt-levelsBegin)];
+        for (int s=0; s<4 && edges[s] >= 0; s+=2)
+        {
+          Piece segment;
+          segment.points.resize(2);
+          for (int end=0; end<2; ++end)
+          {
+            qint64 edgeId;
+            QPointF point;
+            switch (edges[s+end])
+            {
+              case 0: edgeId = (qint64(v)*keySize + k)*2;     point = QPointF(k+(level-z[0])/(z[1]-z[0]), v); break;
+              case 1: edgeId = (qint64(v)*keySize + k+1)*2+1; point = QPointF(k+1, v+(level-z[1])/(z[2]-z[1])); break;
+              case 2: edgeId = (qint64(v+1)*keySize + k)*2;   point = QPointF(k+(level-z[3])/(z[2]-z[3]), v+1); break;
+              default: edgeId = (qint64(v)*keySize + k)*2+1;  point = QPointF(k, v+(level-z[0])/(z[3]-z[0])); break;
+            }
+            segment.points[end] = point;
+            if (end == 0)
+              segment.startEdge = edgeId;
+            else
+              segment.endEdge = edgeId;
+          }
+          target.append(segment);
+        }
+      }
+    }
+    qSwap(lowerRow, upperRow);
+  }
+}
+
+/*! \internal
+
+  Draws the contour lines of one level, given in pixel coordinates by \a lineData with NaN points
+  separating the polylines. If the plotting hint \ref QCP::phRasterizedLines is set and the painter
+  allows it, the lines are drawn with the software line rasterizer (\ref QCPLineRasterizer).
+  Otherwise they are drawn as one painter path.
+*/
+void QCPContour::drawContourLines(QCPPainter *painter, const QVector<QPointF> &lineData) const
+{
+  if (mParentPlot->plottingHints().testFlag(QCP::phRasterizedLines))
+  {
+    QCPLineRasterizer rasterizer(painter);
+    if (rasterizer.isValid())
+    {
+      rasterizer.drawPolyline(lineData.constData(), lineData.size());
+      return;
+    }
+  }
+
+  QPainterPath path;
+  bool newPolyline = true;
+  for (int i=0; i<lineData.size(); ++i)
+  {
+    const QPointF &point = lineData.at(i);
+    if (qIsNaN(point.x()) || qIsNaN(point.y()) || qIsInf(point.x()) || qIsInf(point.y()))
+      newPolyline = true;
+    else if (newPolyline)
+    {
+      path.moveTo(point);
+      newPolyline = false;
+    } else
+      path.lineTo(point);
+  }
+  painter->drawPath(path);
+}
+
+/*! \internal
+
+  Joins the \a pieces of one level into polylines and returns them. Two pieces are joined where
+  the end point of one and the start or end point of the other lie on the same grid edge, reversing
+  the second piece if necessary. Closed contours end with their start point.
+
+  Since each edge crossing is shared by at most two pieces, the join partner of a piece end can be
+  looked up directly, which makes stitching linear in the number of pieces.
+*/
+QVector<QCPContour::Piece> QCPContour::stitchPieces(const QVector<Piece> &pieces)
+{
+  QHash<qint64, QPair<int, int> > edgePieces; // the (up to two) pieces ending on each edge
+  edgePieces.reserve(pieces.size()*2);
+  for (int i=0; i<pieces.size(); ++i)
+  {
+    for (int end=0; end<2; ++end)
+    {
+      const qint64 edge = end == 0 ? pieces.at(i).startEdge : pieces.at(i).endEdge;
+      QHash<qint64, QPair<int, int> >::iterator it = edgePieces.find(edge);
+      if (it == edgePieces.end())
+        edgePieces.insert(edge, qMakePair(i, -1));
+      else
+        it.value().second = i;
+    }
+  }
+
+  QVector<Piece> result;
+  QVector<bool> used(pieces.size(), false);
+  for (int i=0; i<pieces.size(); ++i)
+  {
+    if (used.at(i))
+      continue;
+    used[i] = true;
+    Piece chain = pieces.at(i);
+    // extend the chain at its end, then reverse it and extend it at its former start:
+    for (int pass=0; pass<2 && chain.endEdge != chain.startEdge; ++pass)
+    {
+      if (pass == 1)
+      {
+        std::reverse(chain.points.begin(), chain.points.end());
+        qSwap(chain.startEdge, chain.endEdge);
+      }
+      while (chain.endEdge != chain.startEdge)
+      {
+        const QPair<int, int> owners = edgePieces.value(chain.endEdge);
+        int next = -1;
+        if (!used.at(owners.first))
+          next = owners.first;
+        else if (owners.second >= 0 && !used.at(owners.second))
+          next = owners.second;
+        if (next < 0)
+          break;
+        used[next] = true;
+        const Piece &piece = pieces.at(next);
+        const QVector<QPointF> &points = piece.points;
+        if (piece.startEdge == chain.endEdge)
+        {
+          for (int p=1; p<points.size(); ++p) // the first point equals the current chain end
+            chain.points.append(points.at(p));
+          chain.endEdge = piece.endEdge;
+        } else
+        {
+          for (int p=points.size()-2; p>=0; --p)
+            chain.points.append(points.at(p));
+          chain.endEdge = piece.startEdge;
+        }
+      }
+    }
+    result.append(chain);
+  }
+  return result;
+}
+/* end of 'src/plottables/plottable-contour.cpp' */
@@ -0,0 +1,69 @@
+#pragma once
+#include "src/global.h"
+#include "src/plottable.h"
+#include "src/axis/axis.h"
+#include "src/plottables/plottable-colormap.h"
+
+class QCP_LIB_DECL QCPContour : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QVector<double> levels READ levels WRITE setLevels)
+  /// \endcond
+public:
+  explicit QCPContour(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPContour() Q_DECL_OVERRIDE;
+
+  // getters:
+  QCPColorMapData *data() const { return mMapData; }
+  QVector<double> levels() const { return mLevels; }
+
+  // setters:
+  void setData(QCPColorMapData *data, bool copy=false);
+  void setLevels(const QVector<double> &levels);
+
+  // non-property methods:
+  void setEquidistantLevels(int levelCount);
+
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+
+protected:
+  /*! \internal
+    A piece of a contour line, in cell index coordinates. The start and end points lie on the grid
+    edges identified by \a startEdge and \a endEdge (see \ref traceBand), which is how pieces are
+    joined by \ref stitchPieces.
+  */
+  struct Piece
+  {
+    qint64 startEdge, endEdge;
+    QVector<QPointF> points;
+  };
+
+  // property members:
+  QCPColorMapData *mMapData;
+  QVector<double> mLevels;
+
+  // non-property members:
+  QVector<QVector<QVector<QPointF> > > mContourLines; // polylines of each level, in cell index coordinates
+  bool mContoursInvalidated;
+
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+
+  // introduced virtual methods:
+  virtual void updateContours();
+
+  // non-virtual methods:
+  void traceBand(int valueBegin, int valueEnd, QVector<QVector<Piece> > &levelSegments) const;
+  void drawContourLines(QCPPainter *painter, const QVector<QPointF> &lineData) const;
+  static QVector<Piece> stitchPieces(const QVector<Piece> &pieces);
+
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
+/* end of 'src/plottables/plottable-contour.h' */
@@ -160,7 +160,8 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable1D<QCPCurveData>(keyAxis, valueAxis),
   mScatterSkip{},
-  mLineStyle{}
+  mLineStyle{},
+  mAdaptiveSampling{}
 {
   // modify inherited properties from abstract plottable:
   setPen(QPen(Qt::blue, 0));
@@ -169,6 +170,7 @@ QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterStyle(QCPScatterStyle());
   setLineStyle(lsLine);
   setScatterSkip(0);
+  setAdaptiveSampling(true);
 }
 
 QCPCurve::~QCPCurve()
@@ -270,6 +272,25 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
   mLineStyle = style;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. Similar to \ref
+  QCPGraph::setAdaptiveSampling, this can drastically improve the replot performance for curves
+  with a large number of points (e.g. long trajectories or dense parametric curves), without
+  visibly changing the appearance of the curve.
+
+  The curve's adaptive sampling operates in pixel space and honors the \a t order of the data:
+  Consecutive visible data points which fall into the same pixel are collapsed, such that only the
+  first and the last point of each such run are passed on to the line drawing. The deviation from
+  the exact curve is thus always below one pixel, while the number of drawn line segments is
+  limited by the number of pixel transitions of the curve, instead of its data point count.
+
+  By default, adaptive sampling is enabled.
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a t, \a keys and \a values to the current data. The provided vectors
@@ -567,6 +588,9 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &poin
   function. This is needed here to calculate an accordingly wider margin around the axis rect when
   performing the line optimization.
 
+  If adaptive sampling is enabled (\ref setAdaptiveSampling), runs of consecutive visible points that
+  fall into the same pixel are collapsed to the first and last point of the run.
+
   Methods that are also involved in the algorithm are: \ref getRegion, \ref getOptimizedPoint, \ref
   getOptimizedCornerPoints \ref mayTraverse, \ref getTraverse, \ref getTraverseCornerPoints.
 
@@ -595,11 +619,18 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
   QCPCurveDataContainer::const_iterator prevIt = itEnd-1;
   int prevRegion = getRegion(prevIt->key, prevIt->value, keyMin, valueMax, keyMax, valueMin);
   QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
+  QPointF runEndPoint; // with adaptive sampling, the last point of the current run of points inside the pixel of lines->last()
+  bool hasRunEndPoint = false;
   while (it != itEnd)
   {
     const int currentRegion = getRegion(it->key, it->value, keyMin, valueMax, keyMax, valueMin);
     if (currentRegion != prevRegion) // changed region, possibly need to add some optimized edge points or original points if entering R
     {
+      if (hasRunEndPoint) // close the pending pixel run before adding any other points
+      {
+        lines->append(runEndPoint);
+        hasRunEndPoint = false;
+      }
       if (currentRegion != 5) // segment doesn't end in R, so it's a candidate for removal
       {
         QPointF crossA, crossB;
@@ -642,7 +673,23 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
     {
       if (currentRegion == 5) // still in R, keep adding original points
       {
-        lines->append(coordsToPixels(it->key, it->value));
+        const QPointF point = coordsToPixels(it->key, it->value);
+        if (mAdaptiveSampling && !lines->isEmpty() && !qIsNaN(point.x()) && !qIsNaN(point.y()) &&
+            !qIsNaN(lines->last().x()) && !qIsNaN(lines->last().y()) &&
+            qFloor(point.x()) == qFloor(lines->last().x()) && qFloor(point.y()) == qFloor(lines->last().y()))
+        {
+          // point is in the same pixel as the previously added one, only remember it as potential end of the pixel run:
+          runEndPoint = point;
+          hasRunEndPoint = true;
+        } else
+        {
+          if (hasRunEndPoint)
+          {
+            lines->append(runEndPoint);
+            hasRunEndPoint = false;
+          }
+          lines->append(point);
+        }
       } else // still outside R, no need to add anything
       {
         // see how this is not doing anything? That's the main optimization...
@@ -652,6 +699,8 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
     prevRegion = currentRegion;
     ++it;
   }
+  if (hasRunEndPoint)
+    lines->append(runEndPoint);
   *lines << trailingPoints;
 }
 
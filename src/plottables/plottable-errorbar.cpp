@@ -79,6 +79,13 @@ QCPErrorBarsData::QCPErrorBarsData(double errorMinus, double errorPlus) :
   whiskers (\ref setWhiskerWidth). Further, the error bar backbones may leave a gap around the data
   point center to prevent that error bars are drawn too close to or even through scatter points.
   This gap size can be controlled via \ref setSymbolGap.
+
+  \section qcperrorbars-performance Performance
+
+  The pixel positions of the data points are requested from the data plottable for whole index
+  ranges at once (\ref QCPPlottableInterface1D::dataPixelPositions), instead of one virtual call
+  per error bar. If there are many more error bars than pixels, they are combined per pixel column
+  to an envelope, see \ref setAdaptiveSampling.
 */
 
 /* start of documentation of inline functions */
@@ -110,7 +117,8 @@ QCPErrorBars::QCPErrorBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mDataContainer(new QVector<QCPErrorBarsData>),
   mErrorType(etValueError),
   mWhiskerWidth(9),
-  mSymbolGap(10)
+  mSymbolGap(10),
+  mAdaptiveSampling(true)
 {
   setPen(QPen(Qt::black, 0));
   setBrush(Qt::NoBrush);
@@ -234,6 +242,26 @@ void QCPErrorBars::setSymbolGap(double pixels)
   mSymbolGap = pixels;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when drawing the error bars. This can drastically
+  improve the replot performance when the data plottable has many more data points than the axis
+  rect has pixels, where individual error bars would merely form a solid smear anyway.
+
+  If enabled and there are more visible error bars than pixel columns (perpendicular to the error
+  direction), all error bars whose centers fall into the same pixel column are replaced by one
+  backbone spanning from the lowest to the highest error bar end in that column, and one whisker
+  at each of these two ends. The symbol gap (\ref setSymbolGap) is not applied to such combined
+  error bars. Columns which contain a single error bar are drawn exactly as without adaptive
+  sampling. The number of drawn lines is thus bounded by the axis rect size, independent of the
+  number of error bars.
+
+  By default, adaptive sampling is enabled.
+*/
+void QCPErrorBars::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
 
   Adds symmetrical error values as specified in \a error. The errors will be associated one-to-one
@@ -440,6 +468,48 @@ int QCPErrorBars::findEnd(double sortKey, bool expandedRange) const
   return 0;
 }
 
+/*!
+  Forwards the request to the data plottable's \ref QCPPlottableInterface1D::dataMainKeys, since
+  the error bars adopt the keys of its data points.
+
+  \seebaseclassmethod
+*/
+void QCPErrorBars::dataMainKeys(int begin, int end, double *keys) const
+{
+  if (mDataPlottable)
+    mDataPlottable->interface1D()->dataMainKeys(begin, end, keys);
+  else
+    qDebug() << Q_FUNC_INFO << "no data plottable set";
+}
+
+/*!
+  Forwards the request to the data plottable's \ref QCPPlottableInterface1D::dataMainValues, since
+  the error bars adopt the values of its data points.
+
+  \seebaseclassmethod
+*/
+void QCPErrorBars::dataMainValues(int begin, int end, double *values) const
+{
+  if (mDataPlottable)
+    mDataPlottable->interface1D()->dataMainValues(begin, end, values);
+  else
+    qDebug() << Q_FUNC_INFO << "no data plottable set";
+}
+
+/*!
+  Forwards the request to the data plottable's \ref QCPPlottableInterface1D::dataPixelPositions,
+  since the error bars adopt the positions of its data points.
+
+  \seebaseclassmethod
+*/
+void QCPErrorBars::dataPixelPositions(int begin, int end, QPointF *positions) const
+{
+  if (mDataPlottable)
+    mDataPlottable->interface1D()->dataPixelPositions(begin, end, positions);
+  else
+    qDebug() << Q_FUNC_INFO << "no data plottable set";
+}
+
 /*!
   Implements a selectTest specific to this plottable's point geometry.
 
@@ -499,11 +569,15 @@ void QCPErrorBars::draw(QCPPainter *painter)
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
   QVector<QLineF> backbones, whiskers;
+  QVector<QPointF> centerPixels;
+  const int dataPlottableCount = mDataPlottable->interface1D()->dataCount();
   for (int i=0; i<allSegments.size(); ++i)
   {
     QCPErrorBarsDataContainer::const_iterator begin, end;
     getVisibleDataBounds(begin, end, allSegments.at(i));
-    if (begin == end)
+    if (end-mDataContainer->constBegin() > dataPlottableCount) // error bars without a data point in the data plottable can't be drawn
+      end = mDataContainer->constBegin()+dataPlottableCount;
+    if (begin >= end)
       continue;
     
     bool isSelectedSegment = i >= unselectedSegments.size();
@@ -517,12 +591,20 @@ void QCPErrorBars::draw(QCPPainter *painter)
       capFixPen.setCapStyle(Qt::FlatCap);
       painter->setPen(capFixPen);
     }
+    // get the pixel positions of all data points in the segment with a single call to the data plottable:
+    const int beginIndex = int(begin-mDataContainer->constBegin());
+    centerPixels.resize(int(end-begin));
+    mDataPlottable->interface1D()->dataPixelPositions(beginIndex, beginIndex+centerPixels.size(), centerPixels.data());
     backbones.clear();
     whiskers.clear();
-    for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+    if (!mAdaptiveSampling || !getErrorBarEnvelopeLines(begin, end, centerPixels.constData(), checkPointVisibility, backbones, whiskers))
     {
-      if (!checkPointVisibility || errorBarVisible(int(it-mDataContainer->constBegin())))
-        getErrorBarLines(it, backbones, whiskers);
+      const QPointF *centerPixel = centerPixels.constData();
+      for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it, ++centerPixel)
+      {
+        if (!checkPointVisibility || errorBarVisible(int(it-mDataContainer->constBegin()), *centerPixel))
+          getErrorBarLines(it, *centerPixel, backbones, whiskers);
+      }
     }
     painter->drawLines(backbones);
     painter->drawLines(whiskers);
@@ -563,49 +645,58 @@ QCPRange QCPErrorBars::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomai
   QCPRange range;
   bool haveLower = false;
   bool haveUpper = false;
-  QCPErrorBarsDataContainer::const_iterator it;
-  for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
+  // get the data point keys in chunks via the bulk interface, instead of one virtual call per error bar:
+  const int n = qMin(mDataContainer->size(), mDataPlottable->interface1D()->dataCount());
+  const int chunkSize = 4096;
+  QVector<double> keys;
+  for (int chunkBegin=0; chunkBegin<n; chunkBegin+=keys.size())
   {
-    if (mErrorType == etValueError)
+    keys.resize(qMin(n-chunkBegin, chunkSize));
+    mDataPlottable->interface1D()->dataMainKeys(chunkBegin, chunkBegin+keys.size(), keys.data());
+    QCPErrorBarsDataContainer::const_iterator it = mDataContainer->constBegin()+chunkBegin;
+    for (int i=0; i<keys.size(); ++i, ++it)
     {
-      // error bar doesn't extend in key dimension (except whisker but we ignore that here), so only use data point center
-      const double current = mDataPlottable->interface1D()->dataMainKey(int(it-mDataContainer->constBegin()));
-      if (qIsNaN(current)) continue;
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
+      if (mErrorType == etValueError)
       {
-        if (current < range.lower || !haveLower)
+        // error bar doesn't extend in key dimension (except whisker but we ignore that here), so only use data point center
+        const double current = keys.at(i);
+        if (qIsNaN(current)) continue;
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.lower = current;
-          haveLower = true;
+          if (current < range.lower || !haveLower)
+          {
+            range.lower = current;
+            haveLower = true;
+          }
+          if (current > range.upper || !haveUpper)
+          {
+            range.upper = current;
+            haveUpper = true;
+          }
         }
-        if (current > range.upper || !haveUpper)
-        {
-          range.upper = current;
-          haveUpper = true;
-        }
-      }
-    } else // mErrorType == etKeyError
-    {
-      const double dataKey = mDataPlottable->interface1D()->dataMainKey(int(it-mDataContainer->constBegin()));
-      if (qIsNaN(dataKey)) continue;
-      // plus error:
-      double current = dataKey + (qIsNaN(it->errorPlus) ? 0 : it->errorPlus);
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
+      } else // mErrorType == etKeyError
       {
-        if (current > range.upper || !haveUpper)
+        const double dataKey = keys.at(i);
+        if (qIsNaN(dataKey)) continue;
+        // plus error:
+        double current = dataKey + (qIsNaN(it->errorPlus) ? 0 : it->errorPlus);
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.upper = current;
-          haveUpper = true;
+          if (current > range.upper || !haveUpper)
+          {
+            range.upper = current;
+            haveUpper = true;
+          }
         }
-      }
-      // minus error:
-      current = dataKey - (qIsNaN(it->errorMinus) ? 0 : it->errorMinus);
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
-      {
-        if (current < range.lower || !haveLower)
+        // minus error:
+        current = dataKey - (qIsNaN(it->errorMinus) ? 0 : it->errorMinus);
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.lower = current;
-          haveLower = true;
+          if (current < range.lower || !haveLower)
+          {
+            range.lower = current;
+            haveLower = true;
+          }
         }
       }
     }
@@ -638,61 +729,75 @@ QCPRange QCPErrorBars::getValueRange(bool &foundRange, QCP::SignDomain inSignDom
   const bool restrictKeyRange = inKeyRange != QCPRange();
   bool haveLower = false;
   bool haveUpper = false;
-  QCPErrorBarsDataContainer::const_iterator itBegin = mDataContainer->constBegin();
-  QCPErrorBarsDataContainer::const_iterator itEnd = mDataContainer->constEnd();
+  int beginIndex = 0;
+  int endIndex = qMin(mDataContainer->size(), mDataPlottable->interface1D()->dataCount());
   if (mDataPlottable->interface1D()->sortKeyIsMainKey() && restrictKeyRange)
   {
-    itBegin = mDataContainer->constBegin()+findBegin(inKeyRange.lower, false);
-    itEnd = mDataContainer->constBegin()+findEnd(inKeyRange.upper, false);
+    beginIndex = qMax(beginIndex, findBegin(inKeyRange.lower, false));
+    endIndex = qMin(endIndex, findEnd(inKeyRange.upper, false));
   }
-  for (QCPErrorBarsDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
+  // get the data point keys and values in chunks via the bulk interface, instead of one virtual call per error bar:
+  const int chunkSize = 4096;
+  QVector<double> keys, values;
+  for (int chunkBegin=beginIndex; chunkBegin<endIndex; chunkBegin+=values.size())
   {
+    values.resize(qMin(endIndex-chunkBegin, chunkSize));
+    mDataPlottable->interface1D()->dataMainValues(chunkBegin, chunkBegin+values.size(), values.data());
     if (restrictKeyRange)
     {
-      const double dataKey = mDataPlottable->interface1D()->dataMainKey(int(it-mDataContainer->constBegin()));
-      if (dataKey < inKeyRange.lower || dataKey > inKeyRange.upper)
-        continue;
+      keys.resize(values.size());
+      mDataPlottable->interface1D()->dataMainKeys(chunkBegin, chunkBegin+keys.size(), keys.data());
     }
-    if (mErrorType == etValueError)
+    QCPErrorBarsDataContainer::const_iterator it = mDataContainer->constBegin()+chunkBegin;
+    for (int i=0; i<values.size(); ++i, ++it)
     {
-      const double dataValue = mDataPlottable->interface1D()->dataMainValue(int(it-mDataContainer->constBegin()));
-      if (qIsNaN(dataValue)) continue;
-      // plus error:
-      double current = dataValue + (qIsNaN(it->errorPlus) ? 0 : it->errorPlus);
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
+      if (restrictKeyRange)
       {
-        if (current > range.upper || !haveUpper)
-        {
-          range.upper = current;
-          haveUpper = true;
-        }
+        const double dataKey = keys.at(i);
+        if (dataKey < inKeyRange.lower || dataKey > inKeyRange.upper)
+          continue;
       }
-      // minus error:
-      current = dataValue - (qIsNaN(it->errorMinus) ? 0 : it->errorMinus);
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
+      if (mErrorType == etValueError)
       {
-        if (current < range.lower || !haveLower)
+        const double dataValue = values.at(i);
+        if (qIsNaN(dataValue)) continue;
+        // plus error:
+        double current = dataValue + (qIsNaN(it->errorPlus) ? 0 : it->errorPlus);
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.lower = current;
-          haveLower = true;
+          if (current > range.upper || !haveUpper)
+          {
+            range.upper = current;
+            haveUpper = true;
+          }
         }
-      }
-    } else // mErrorType == etKeyError
-    {
-      // error bar doesn't extend in value dimension (except whisker but we ignore that here), so only use data point center
-      const double current = mDataPlottable->interface1D()->dataMainValue(int(it-mDataContainer->constBegin()));
-      if (qIsNaN(current)) continue;
-      if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
-      {
-        if (current < range.lower || !haveLower)
+        // minus error:
+        current = dataValue - (qIsNaN(it->errorMinus) ? 0 : it->errorMinus);
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.lower = current;
-          haveLower = true;
+          if (current < range.lower || !haveLower)
+          {
+            range.lower = current;
+            haveLower = true;
+          }
         }
-        if (current > range.upper || !haveUpper)
+      } else // mErrorType == etKeyError
+      {
+        // error bar doesn't extend in value dimension (except whisker but we ignore that here), so only use data point center
+        const double current = values.at(i);
+        if (qIsNaN(current)) continue;
+        if (inSignDomain == QCP::sdBoth || (inSignDomain == QCP::sdNegative && current < 0) || (inSignDomain == QCP::sdPositive && current > 0))
         {
-          range.upper = current;
-          haveUpper = true;
+          if (current < range.lower || !haveLower)
+          {
+            range.lower = current;
+            haveLower = true;
+          }
+          if (current > range.upper || !haveUpper)
+          {
+            range.upper = current;
+            haveUpper = true;
+          }
         }
       }
     }
@@ -727,8 +832,18 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
 {
   if (!mDataPlottable) return;
   
-  int index = int(it-mDataContainer->constBegin());
-  QPointF centerPixel = mDataPlottable->interface1D()->dataPixelPosition(index);
+  getErrorBarLines(it, mDataPlottable->interface1D()->dataPixelPosition(int(it-mDataContainer->constBegin())), backbones, whiskers);
+}
+
+/*! \internal \overload
+
+  Calculates the lines that make up the error bar belonging to the data point \a it, whose pixel
+  position was already retrieved from the data plottable and is passed as \a centerPixel. This
+  allows callers to get the pixel positions of many data points at once, via \ref
+  QCPPlottableInterface1D::dataPixelPositions.
+*/
+void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, const QPointF &centerPixel, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const
+{
   if (qIsNaN(centerPixel.x()) || qIsNaN(centerPixel.y()))
     return;
   QCPAxis *errorAxis = mErrorType == etValueError ? mValueAxis.data() : mKeyAxis.data();
@@ -774,6 +889,123 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
   }
 }
 
+/*! \internal
+
+  Calculates the envelope lines of the error bars from \a begin to \a end, as used by the adaptive
+  sampling (see \ref setAdaptiveSampling), and adds them to \a backbones and \a whiskers.
+
+  \a centerPixels holds the pixel positions of the corresponding data points (one per error bar in
+  the range). If \a checkPointVisibility is true, each error bar is additionally checked with \ref
+  errorBarVisible.
+
+  The error bars are distributed to columns of one pixel along the axis perpendicular to the error
+  direction. Columns with a single error bar get its regular lines (\ref getErrorBarLines), columns
+  with multiple error bars get one backbone from the lowest to the highest error bar end, and
+  whiskers at both ends.
+
+  Returns false without adding lines, if there are fewer error bars than pixel columns, i.e. when
+  the envelope wouldn't reduce the number of drawn lines significantly. The caller should then
+  draw the error bars individually.
+*/
+bool QCPErrorBars::getErrorBarEnvelopeLines(QCPErrorBarsDataContainer::const_iterator begin, QCPErrorBarsDataContainer::const_iterator end, const QPointF *centerPixels, bool checkPointVisibility, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const
+{
+  QCPAxis *errorAxis = mErrorType == etValueError ? mValueAxis.data() : mKeyAxis.data();
+  QCPAxis *orthoAxis = mErrorType == etValueError ? mKeyAxis.data() : mValueAxis.data();
+  const bool errorAxisIsHorizontal = errorAxis->orientation() == Qt::Horizontal;
+  const bool orthoAxisIsHorizontal = orthoAxis->orientation() == Qt::Horizontal;
+  // one column per pixel across the axis rect, with a margin for whiskers reaching in from outside:
+  const QRect axisRect = orthoAxis->axisRect()->rect();
+  const int margin = qCeil(mWhiskerWidth*0.5)+1;
+  const int columnOffset = (orthoAxisIsHorizontal ? axisRect.left() : axisRect.top())-margin;
+  const int columnCount = (orthoAxisIsHorizontal ? axisRect.width() : axisRect.height())+2*margin;
+  const int errorBarCount = int(end-begin);
+  if (errorBarCount <= columnCount)
+    return false;
+  
+  struct Column
+  {
+    int count; // number of error bars in the column, the other members are only valid if non-zero
+    int firstIndex; // index of the first error bar relative to begin, used if it's the only one
+    double orthoPixel; // pixel position of the first error bar's center perpendicular to the error direction
+    double lower, upper; // pixel extent of all backbones, including the centers
+    double whiskerLower, whiskerUpper; // pixel extent of all error bar ends
+  };
+  QVector<Column> columns(columnCount);
+  for (int i=0; i<columnCount; ++i)
+    columns[i].count = 0;
+  
+  int index = int(begin-mDataContainer->constBegin());
+  for (int i=0; i<errorBarCount; ++i, ++index)
+  {
+    const QPointF &centerPixel = centerPixels[i];
+    if (qIsNaN(centerPixel.x()) || qIsNaN(centerPixel.y()))
+      continue;
+    const QCPErrorBarsData &error = mDataContainer->at(index);
+    if (qIsNaN(error.errorMinus) && qIsNaN(error.errorPlus))
+      continue;
+    const double columnPosition = std::floor(orthoAxisIsHorizontal ? centerPixel.x() : centerPixel.y())-columnOffset;
+    if (columnPosition < 0 || columnPosition >= columnCount) // whole error bar outside of axis rect
+      continue;
+    if (checkPointVisibility && !errorBarVisible(index, centerPixel))
+      continue;
+    
+    const double centerErrorAxisPixel = errorAxisIsHorizontal ? centerPixel.x() : centerPixel.y();
+    const double centerErrorAxisCoord = errorAxis->pixelToCoord(centerErrorAxisPixel);
+    Column &column = columns[int(columnPosition)];
+    if (column.count == 0)
+    {
+      column.firstIndex = i;
+      column.orthoPixel = orthoAxisIsHorizontal ? centerPixel.x() : centerPixel.y();
+      column.lower = centerErrorAxisPixel;
+      column.upper = centerErrorAxisPixel;
+      column.whiskerLower = (std::numeric_limits<double>::max)();
+      column.whiskerUpper = -(std::numeric_limits<double>::max)();
+    }
+    ++column.count;
+    column.lower = qMin(column.lower, centerErrorAxisPixel);
+    column.upper = qMax(column.upper, centerErrorAxisPixel);
+    for (int side=0; side<2; ++side)
+    {
+      const double errorValue = side == 0 ? -error.errorMinus : error.errorPlus;
+      if (qIsNaN(errorValue))
+        continue;
+      const double errorEnd = errorAxis->coordToPixel(centerErrorAxisCoord+errorValue);
+      column.lower = qMin(column.lower, errorEnd);
+      column.upper = qMax(column.upper, errorEnd);
+      column.whiskerLower = qMin(column.whiskerLower, errorEnd);
+      column.whiskerUpper = qMax(column.whiskerUpper, errorEnd);
+    }
+  }
+  
+  const double halfWhiskerWidth = mWhiskerWidth*0.5;
+  for (int i=0; i<columnCount; ++i)
+  {
+    const Column &column = columns.at(i);
+    if (column.count == 0)
+      continue;
+    if (column.count == 1)
+    {
+      getErrorBarLines(begin+column.firstIndex, centerPixels[column.firstIndex], backbones, whiskers);
+      continue;
+    }
+    const double o = column.orthoPixel;
+    if (errorAxisIsHorizontal)
+    {
+      backbones.append(QLineF(column.lower, o, column.upper, o));
+      whiskers.append(QLineF(column.whiskerLower, o-halfWhiskerWidth, column.whiskerLower, o+halfWhiskerWidth));
+      if (column.whiskerUpper != column.whiskerLower)
+        whiskers.append(QLineF(column.whiskerUpper, o-halfWhiskerWidth, column.whiskerUpper, o+halfWhiskerWidth));
+    } else
+    {
+      backbones.append(QLineF(o, column.lower, o, column.upper));
+      whiskers.append(QLineF(o-halfWhiskerWidth, column.whiskerLower, o+halfWhiskerWidth, column.whiskerLower));
+      if (column.whiskerUpper != column.whiskerLower)
+        whiskers.append(QLineF(o-halfWhiskerWidth, column.whiskerUpper, o+halfWhiskerWidth, column.whiskerUpper));
+    }
+  }
+  return true;
+}
+
 /*! \internal
 
   This method outputs the currently visible data range via \a begin and \a end. The returned range
@@ -863,14 +1095,20 @@ double QCPErrorBars::pointDistance(const QPointF &pixelPoint, QCPErrorBarsDataCo
   }
   
   QCPErrorBarsDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, QCPDataRange(0, dataCount()));
+  getVisibleDataBounds(begin, end, QCPDataRange(0, qMin(dataCount(), mDataPlottable->interface1D()->dataCount())));
+  const int beginIndex = int(begin-mDataContainer->constBegin());
+  QVector<QPointF> centerPixels(int(end-begin));
+  mDataPlottable->interface1D()->dataPixelPositions(beginIndex, beginIndex+centerPixels.size(), centerPixels.data());
   
   // calculate minimum distances to error backbones (whiskers are ignored for speed) and find closestData iterator:
   double minDistSqr = (std::numeric_limits<double>::max)();
   QVector<QLineF> backbones, whiskers;
-  for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+  const QPointF *centerPixel = centerPixels.constData();
+  for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it, ++centerPixel)
   {
-    getErrorBarLines(it, backbones, whiskers);
+    backbones.clear();
+    whiskers.clear();
+    getErrorBarLines(it, *centerPixel, backbones, whiskers);
     foreach (const QLineF &backbone, backbones)
     {
       const double currentDistSqr = QCPVector2D(pixelPoint).distanceSquaredToLine(backbone);
@@ -921,7 +1159,16 @@ void QCPErrorBars::getDataSegments(QList<QCPDataRange> &selectedSegments, QList<
 */
 bool QCPErrorBars::errorBarVisible(int index) const
 {
-  QPointF centerPixel = mDataPlottable->interface1D()->dataPixelPosition(index);
+  return errorBarVisible(index, mDataPlottable->interface1D()->dataPixelPosition(index));
+}
+
+/*! \internal \overload
+
+  Returns whether the error bar at the specified \a index, whose data point lies at the pixel
+  position \a centerPixel, is visible within the current key axis range.
+*/
+bool QCPErrorBars::errorBarVisible(int index, const QPointF &centerPixel) const
+{
   const double centerKeyPixel = mKeyAxis->orientation() == Qt::Horizontal ? centerPixel.x() : centerPixel.y();
   if (qIsNaN(centerKeyPixel))
     return false;
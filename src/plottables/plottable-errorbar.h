@@ -41,6 +41,7 @@ class QCP_LIB_DECL QCPErrorBars : public QCPAbstractPlottable, public QCPPlottab
   Q_PROPERTY(ErrorType errorType READ errorType WRITE setErrorType)
   Q_PROPERTY(double whiskerWidth READ whiskerWidth WRITE setWhiskerWidth)
   Q_PROPERTY(double symbolGap READ symbolGap WRITE setSymbolGap)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   
@@ -63,6 +64,7 @@ public:
   ErrorType errorType() const { return mErrorType; }
   double whiskerWidth() const { return mWhiskerWidth; }
   double symbolGap() const { return mSymbolGap; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPErrorBarsDataContainer> data);
@@ -72,6 +74,7 @@ public:
   void setErrorType(ErrorType type);
   void setWhiskerWidth(double pixels);
   void setSymbolGap(double pixels);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &error);
@@ -90,6 +93,9 @@ public:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
   virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual void dataMainKeys(int begin, int end, double *keys) const Q_DECL_OVERRIDE;
+  virtual void dataMainValues(int begin, int end, double *values) const Q_DECL_OVERRIDE;
+  virtual void dataPixelPositions(int begin, int end, QPointF *positions) const Q_DECL_OVERRIDE;
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
@@ -102,6 +108,7 @@ protected:
   ErrorType mErrorType;
   double mWhiskerWidth;
   double mSymbolGap;
+  bool mAdaptiveSampling;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -111,11 +118,14 @@ protected:
   
   // non-virtual methods:
   void getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
+  void getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, const QPointF &centerPixel, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
+  bool getErrorBarEnvelopeLines(QCPErrorBarsDataContainer::const_iterator begin, QCPErrorBarsDataContainer::const_iterator end, const QPointF *centerPixels, bool checkPointVisibility, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
   void getVisibleDataBounds(QCPErrorBarsDataContainer::const_iterator &begin, QCPErrorBarsDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   double pointDistance(const QPointF &pixelPoint, QCPErrorBarsDataContainer::const_iterator &closestData) const;
   // helpers:
   void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const;
   bool errorBarVisible(int index) const;
+  bool errorBarVisible(int index, const QPointF &centerPixel) const;
   bool rectIntersectsLine(const QRectF &pixelRect, const QLineF &line) const;
   
   friend class QCustomPlot;
@@ -1,5 +1,6 @@
 #include "src/plottables/plottable-financial.h"
 #include "src/layoutelements/layoutelement-axisrect.h"
+#include "src/parallel.h"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPFinancialData
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -122,6 +123,15 @@ QCPFinancialData::QCPFinancialData(double key, double open, double high, double
   setWidthType. A typical choice is to set the width type to \ref wtPlotCoords (the default) and
   the width to (or slightly less than) one time bin interval width.
 
+  \section qcpfinancial-timeframes Timeframe pyramid
+
+  For long tick series, QCPFinancial can aggregate the raw ticks itself, on multiple timeframes at
+  once. Set the timeframes (bin sizes, e.g. 1 second, 1 minute, 1 hour, 1 day) with \ref
+  setTimeframes and feed the ticks with \ref addTicks. Each timeframe level is updated
+  incrementally. The finest timeframe whose candles are at least \ref setMinimumCandleWidth
+  pixels wide is displayed automatically, so zooming from years to seconds always shows a bounded
+  number of readable candles.
+
   \section qcpfinancial-appearance Changing the appearance
 
   Charts can be either single- or two-colored (\ref setTwoColored). If set to be single-colored,
@@ -159,6 +169,17 @@ QCPFinancialData::QCPFinancialData(double key, double open, double high, double
   Returns a pointer to the internal data storage of type \ref QCPFinancialDataContainer. You may
   use it to directly manipulate the data, which may be more convenient and faster than using the
   regular \ref setData or \ref addData methods, in certain situations.
+  
+  In the timeframe pyramid mode (\ref setTimeframes), this container is not displayed. The
+  aggregated candles are accessed with \ref timeframeData instead.
+*/
+
+/*! \fn double QCPFinancial::activeTimeframe() const
+  
+  Returns the timeframe currently displayed in the timeframe pyramid mode, or 0 if the mode isn't
+  active.
+  
+  \see setTimeframes, updateActiveTimeframe
 */
 
 /* end of documentation of inline functions */
@@ -182,9 +203,15 @@ QCPFinancial::QCPFinancial(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mBrushPositive(QBrush(QColor(50, 160, 0))),
   mBrushNegative(QBrush(QColor(180, 0, 15))),
   mPenPositive(QPen(QColor(40, 150, 0))),
-  mPenNegative(QPen(QColor(170, 5, 5)))
+  mPenNegative(QPen(QColor(170, 5, 5))),
+  mMinimumCandleWidth(4),
+  mTickTimeframe(0),
+  mActiveTimeframe(-1)
 {
   mSelectionDecorator->setBrush(QBrush(QColor(160, 160, 255)));
+  // choose the displayed timeframe level for the current key axis, range and geometry before each replot draws:
+  if (mParentPlot)
+    connect(mParentPlot, SIGNAL(afterLayout()), this, SLOT(updateActiveTimeframe()));
 }
 
 QCPFinancial::~QCPFinancial()
@@ -240,6 +267,9 @@ void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
   Sets the width of the individual bars/candlesticks to \a width in plot key coordinates.
   
   A typical choice is to set it to (or slightly less than) one bin interval width.
+  
+  If timeframes are set (\ref setTimeframes), \a width is given as a fraction of the currently
+  displayed timeframe instead, e.g. 0.8 for candles that cover 80% of their bin.
 */
 void QCPFinancial::setWidth(double width)
 {
@@ -329,6 +359,80 @@ void QCPFinancial::setPenNegative(const QPen &pen)
   mPenNegative = pen;
 }
 
+/*!
+  Enables the timeframe pyramid mode with the given \a timeframes, i.e. the time bin sizes in key
+  coordinates, for example <tt>{1, 60, 300, 3600, 86400}</tt> for 1s/1m/5m/1h/1d candles if the
+  keys are given in seconds.
+  
+  For each timeframe, a separate data container is maintained, which is filled with aggregated OHLC
+  data by \ref addTicks and can be accessed with \ref timeframeData. The finest timeframe whose
+  candles are at least \ref setMinimumCandleWidth pixels wide at the current key axis range is
+  displayed instead of the plottable's data container (\ref data), which itself stays untouched.
+  The timeframe currently displayed is returned by \ref activeTimeframe, see \ref
+  updateActiveTimeframe for when it is chosen. Data selections and the 1d plottable interface (e.g.
+  \ref dataCount, \ref dataMainKey) refer to the candles of the displayed timeframe, selections are
+  cleared when it changes.
+  
+  Bins are aligned to multiples of the timeframe, with the candle key at the bin center, the same
+  way as \ref timeSeriesToOhlc with zero offset does.
+  
+  The key and value ranges (\ref getKeyRange, \ref getValueRange, and thus \ref rescaleAxes) are
+  determined from the finest timeframe, so they don't depend on the current zoom.
+  
+  Setting new timeframes discards all previously aggregated data. Pass an empty vector to leave the
+  timeframe pyramid mode, the plottable's data container (\ref data) is then displayed again.
+  
+  \see timeframeData
+*/
+void QCPFinancial::setTimeframes(const QVector<double> &timeframes)
+{
+  mTimeframes.clear();
+  foreach (double timeframe, timeframes)
+  {
+    if (timeframe > 0 && qIsFinite(timeframe))
+      mTimeframes.append(timeframe);
+    else
+      qDebug() << Q_FUNC_INFO << "ignoring invalid timeframe" << timeframe;
+  }
+  std::sort(mTimeframes.begin(), mTimeframes.end());
+  mTimeframes.erase(std::unique(mTimeframes.begin(), mTimeframes.end()), mTimeframes.end());
+  
+  mTimeframeLevels.clear();
+  for (int i=0; i<mTimeframes.size(); ++i)
+    mTimeframeLevels.append(QSharedPointer<QCPFinancialDataContainer>(new QCPFinancialDataContainer));
+  mActiveTimeframe = -1;
+  if (!mSelection.isEmpty())
+    setSelection(QCPDataSelection());
+  updateActiveTimeframe();
+}
+
+/*!
+  Sets the minimum width in pixels a candle needs to have, for its timeframe to be chosen in the
+  timeframe pyramid mode (\ref setTimeframes). If even the coarsest timeframe has narrower
+  candles, the coarsest timeframe is used.
+  
+  The candle width considered here is the full bin width, independent of \ref setWidth.
+*/
+void QCPFinancial::setMinimumCandleWidth(double pixels)
+{
+  mMinimumCandleWidth = pixels;
+  updateActiveTimeframe();
+}
+
+/*!
+  Sets the timeframe (time bin size in key coordinates) that \ref addTick uses to aggregate ticks
+  into the plottable's data, when not in the timeframe pyramid mode (\ref setTimeframes).
+  
+  The default is 0, meaning no tick timeframe is set.
+*/
+void QCPFinancial::setTickTimeframe(double timeframe)
+{
+  if (timeframe >= 0 && qIsFinite(timeframe))
+    mTickTimeframe = timeframe;
+  else
+    qDebug() << Q_FUNC_INFO << "invalid timeframe" << timeframe;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys, \a open, \a high, \a low and \a close to the current data.
@@ -380,24 +484,287 @@ void QCPFinancial::addData(double key, double open, double high, double low, dou
   mDataContainer->add(QCPFinancialData(key, open, high, low, close));
 }
 
+/*!
+  Aggregates the raw ticks given by \a time and \a price into all timeframe levels set with \ref
+  setTimeframes. The provided vectors should have equal length. Else, the number of added ticks
+  will be the size of the smaller vector.
+  
+  The levels are updated incrementally, so ticks can be added in chunks as they arrive. Ticks
+  should be passed in chronological order. In that case, each tick either updates the last candle
+  of a level in place or appends a new one. Ticks that are older than the last candle of a level
+  only extend the high/low of their candle (or create it, if it doesn't exist yet), since the
+  order of open and close can't be known for them.
+  
+  The levels are independent of each other and are thus aggregated in parallel.
+  
+  \see timeframeData
+*/
+void QCPFinancial::addTicks(const QVector<double> &time, const QVector<double> &price)
+{
+  if (mTimeframeLevels.isEmpty())
+  {
+    qDebug() << Q_FUNC_INFO << "no timeframes set, use setTimeframes first";
+    return;
+  }
+  if (time.size() != price.size())
+    qDebug() << Q_FUNC_INFO << "time and price have different sizes:" << time.size() << price.size();
+  const int n = qMin(time.size(), price.size());
+  if (n == 0)
+    return;
+  
+  const double *timeData = time.constData();
+  const double *priceData = price.constData();
+  qcpParallelFor(0, mTimeframeLevels.size(), 1, [this, timeData, priceData, n](int levelBegin, int levelEnd)
+  {
+    for (int level=levelBegin; level<levelEnd; ++level)
+    {
+      QCPFinancialDataContainer &candles = *mTimeframeLevels.at(level);
+      const double timeBinSize = mTimeframes.at(level);
+      for (int i=0; i<n; ++i)
+        addTickToCandles(candles, timeData[i], priceData[i], timeBinSize);
+    }
+  });
+}
+
+/*!
+  Adds a single tick (\a price at \a time) to the OHLC data, as typically done for live data. The
+  tick is aggregated with the timeframe set by \ref setTickTimeframe, or into all levels of the
+  timeframe pyramid, if \ref setTimeframes is used.
+  
+  If the tick falls into the bin of the most recent candle, that candle's high, low and close are
+  updated in place. Otherwise a new candle is started, with all four values set to \a price. This
+  makes the cost per tick constant, instead of replacing the last data point via remove and add on
+  the data container. Ticks older than the most recent candle are handled as described in \ref
+  addTicks.
+  
+  Returns true if a new candle was started (in the tick timeframe, or the finest pyramid
+  timeframe), false if an existing candle was updated or the tick couldn't be added.
+  
+  Since only the most recent candle changes with each tick, live charts benefit from placing the
+  financial plottable on its own layer with \ref QCPLayer::lmBuffered mode, and calling \ref
+  QCPLayer::replot on that layer after adding ticks. Only the layer containing the plottable is
+  then redrawn, instead of the whole plot.
+  
+  \see addTicks
+*/
+bool QCPFinancial::addTick(double time, double price)
+{
+  if (!mTimeframeLevels.isEmpty())
+  {
+    bool newCandle = addTickToCandles(*mTimeframeLevels.first(), time, price, mTimeframes.first());
+    for (int level=1; level<mTimeframeLevels.size(); ++level)
+      addTickToCandles(*mTimeframeLevels.at(level), time, price, mTimeframes.at(level));
+    return newCandle;
+  } else if (mTickTimeframe > 0)
+  {
+    return addTickToCandles(*mDataContainer, time, price, mTickTimeframe);
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "no tick timeframe set, use setTickTimeframe or setTimeframes first";
+    return false;
+  }
+}
+
+/*!
+  Returns the data container holding the aggregated candles of the timeframe with index \a level
+  in \ref timeframes. Returns a null pointer if \a level is out of range.
+  
+  \see setTimeframes, addTicks
+*/
+QSharedPointer<QCPFinancialDataContainer> QCPFinancial::timeframeData(int level) const
+{
+  if (level >= 0 && level < mTimeframeLevels.size())
+    return mTimeframeLevels.at(level);
+  qDebug() << Q_FUNC_INFO << "level out of range:" << level;
+  return QSharedPointer<QCPFinancialDataContainer>();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataCount
+  
+  In the timeframe pyramid mode (\ref setTimeframes), this and the other methods of the 1d
+  plottable interface refer to the candles of the displayed timeframe, like data selections do.
+*/
+int QCPFinancial::dataCount() const
+{
+  return displayedData()->size();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainKey
+*/
+double QCPFinancial::dataMainKey(int index) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (index >= 0 && index < data->size())
+  {
+    return (data->constBegin()+index)->mainKey();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
+  }
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataSortKey
+*/
+double QCPFinancial::dataSortKey(int index) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (index >= 0 && index < data->size())
+  {
+    return (data->constBegin()+index)->sortKey();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
+  }
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainValue
+*/
+double QCPFinancial::dataMainValue(int index) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (index >= 0 && index < data->size())
+  {
+    return (data->constBegin()+index)->mainValue();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return 0;
+  }
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataValueRange
+*/
+QCPRange QCPFinancial::dataValueRange(int index) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (index >= 0 && index < data->size())
+  {
+    return (data->constBegin()+index)->valueRange();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return QCPRange(0, 0);
+  }
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataPixelPosition
+*/
+QPointF QCPFinancial::dataPixelPosition(int index) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (index >= 0 && index < data->size())
+  {
+    const QCPFinancialDataContainer::const_iterator it = data->constBegin()+index;
+    return coordsToPixels(it->mainKey(), it->mainValue());
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+    return QPointF();
+  }
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::findBegin
+*/
+int QCPFinancial::findBegin(double sortKey, bool expandedRange) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  return int(data->findBegin(sortKey, expandedRange)-data->constBegin());
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::findEnd
+*/
+int QCPFinancial::findEnd(double sortKey, bool expandedRange) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  return int(data->findEnd(sortKey, expandedRange)-data->constBegin());
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainKeys
+*/
+void QCPFinancial::dataMainKeys(int begin, int end, double *keys) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (begin < 0 || end > data->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  const QCPFinancialDataContainer::const_iterator itEnd = data->constBegin()+end;
+  for (QCPFinancialDataContainer::const_iterator it=data->constBegin()+begin; it!=itEnd; ++it)
+    *keys++ = it->mainKey();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainValues
+*/
+void QCPFinancial::dataMainValues(int begin, int end, double *values) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (begin < 0 || end > data->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  const QCPFinancialDataContainer::const_iterator itEnd = data->constBegin()+end;
+  for (QCPFinancialDataContainer::const_iterator it=data->constBegin()+begin; it!=itEnd; ++it)
+    *values++ = it->mainValue();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataPixelPositions
+*/
+void QCPFinancial::dataPixelPositions(int begin, int end, QPointF *positions) const
+{
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if (begin < 0 || end > data->size() || begin > end)
+  {
+    qDebug() << Q_FUNC_INFO << "Index range out of bounds" << begin << end;
+    return;
+  }
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const QCPFinancialDataContainer::const_iterator itEnd = data->constBegin()+end;
+  for (QCPFinancialDataContainer::const_iterator it=data->constBegin()+begin; it!=itEnd; ++it)
+  {
+    const double keyPixel = keyAxis->coordToPixel(it->mainKey());
+    const double valuePixel = valueAxis->coordToPixel(it->mainValue());
+    *positions++ = keyIsHorizontal ? QPointF(keyPixel, valuePixel) : QPointF(valuePixel, keyPixel);
+  }
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::selectTestRect
 */
 QCPDataSelection QCPFinancial::selectTestRect(const QRectF &rect, bool onlySelectable) const
 {
   QCPDataSelection result;
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if ((onlySelectable && mSelectable == QCP::stNone) || data->isEmpty())
     return result;
   if (!mKeyAxis || !mValueAxis)
     return result;
   
   QCPFinancialDataContainer::const_iterator visibleBegin, visibleEnd;
-  getVisibleDataBounds(visibleBegin, visibleEnd);
+  getVisibleDataBounds(*data, visibleBegin, visibleEnd);
   
   for (QCPFinancialDataContainer::const_iterator it=visibleBegin; it!=visibleEnd; ++it)
   {
     if (rect.intersects(selectionHitBox(it)))
-      result.addDataRange(QCPDataRange(int(it-mDataContainer->constBegin()), int(it-mDataContainer->constBegin()+1)), false);
+      result.addDataRange(QCPDataRange(int(it-data->constBegin()), int(it-data->constBegin()+1)), false);
   }
   result.simplify();
   return result;
@@ -414,7 +781,8 @@ QCPDataSelection QCPFinancial::selectTestRect(const QRectF &rect, bool onlySelec
 double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
   Q_UNUSED(details)
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  if ((onlySelectable && mSelectable == QCP::stNone) || data->isEmpty())
     return -1;
   if (!mKeyAxis || !mValueAxis)
     return -1;
@@ -423,8 +791,8 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
   {
     // get visible data range:
     QCPFinancialDataContainer::const_iterator visibleBegin, visibleEnd;
-    QCPFinancialDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
-    getVisibleDataBounds(visibleBegin, visibleEnd);
+    QCPFinancialDataContainer::const_iterator closestDataPoint = data->constEnd();
+    getVisibleDataBounds(*data, visibleBegin, visibleEnd);
     // perform select test according to configured style:
     double result = -1;
     switch (mChartStyle)
@@ -436,7 +804,7 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
     }
     if (details)
     {
-      int pointIndex = int(closestDataPoint-mDataContainer->constBegin());
+      int pointIndex = int(closestDataPoint-data->constBegin());
       details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
     }
     return result;
@@ -448,14 +816,18 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
 /* inherits documentation from base class */
 QCPRange QCPFinancial::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
-  QCPRange range = mDataContainer->keyRange(foundRange, inSignDomain);
+  // in the timeframe pyramid mode, use the finest level, so the range doesn't depend on the zoom:
+  const bool pyramid = !mTimeframeLevels.isEmpty();
+  const QCPFinancialDataContainer &data = pyramid ? *mTimeframeLevels.first() : *mDataContainer;
+  const double halfWidth = (pyramid ? mWidth*mTimeframes.first() : mWidth)*0.5;
+  QCPRange range = data.keyRange(foundRange, inSignDomain);
   // determine exact range by including width of bars/flags:
   if (foundRange)
   {
-    if (inSignDomain != QCP::sdPositive || range.lower-mWidth*0.5 > 0)
-      range.lower -= mWidth*0.5;
-    if (inSignDomain != QCP::sdNegative || range.upper+mWidth*0.5 < 0)
-      range.upper += mWidth*0.5;
+    if (inSignDomain != QCP::sdPositive || range.lower-halfWidth > 0)
+      range.lower -= halfWidth;
+    if (inSignDomain != QCP::sdNegative || range.upper+halfWidth < 0)
+      range.upper += halfWidth;
   }
   return range;
 }
@@ -463,6 +835,9 @@ QCPRange QCPFinancial::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomai
 /* inherits documentation from base class */
 QCPRange QCPFinancial::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  // in the timeframe pyramid mode, use the finest level, so the range doesn't depend on the zoom:
+  if (!mTimeframeLevels.isEmpty())
+    return mTimeframeLevels.first()->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
@@ -522,20 +897,22 @@ QCPFinancialDataContainer QCPFinancial::timeSeriesToOhlc(const QVector<double> &
 /* inherits documentation from base class */
 void QCPFinancial::draw(QCPPainter *painter)
 {
+  const QSharedPointer<QCPFinancialDataContainer> data = displayedData();
+  
   // get visible data range:
   QCPFinancialDataContainer::const_iterator visibleBegin, visibleEnd;
-  getVisibleDataBounds(visibleBegin, visibleEnd);
+  getVisibleDataBounds(*data, visibleBegin, visibleEnd);
   
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
-  getDataSegments(selectedSegments, unselectedSegments);
+  getDataSegments(selectedSegments, unselectedSegments, data->size());
   allSegments << unselectedSegments << selectedSegments;
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
     QCPFinancialDataContainer::const_iterator begin = visibleBegin;
     QCPFinancialDataContainer::const_iterator end = visibleEnd;
-    mDataContainer->limitIteratorsToDataRange(begin, end, allSegments.at(i));
+    data->limitIteratorsToDataRange(begin, end, allSegments.at(i));
     if (begin == end)
       continue;
     
@@ -625,48 +1002,41 @@ void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataConta
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  if (keyAxis->orientation() == Qt::Horizontal)
+  // collect the lines of rising and falling bars separately, so each group can be drawn with a
+  // single pen setup and drawLines call:
+  const bool splitByTrend = mTwoColored && !(isSelected && mSelectionDecorator);
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  auto pixelPoint = [keyIsHorizontal](double keyPixel, double valuePixel) { return keyIsHorizontal ? QPointF(keyPixel, valuePixel) : QPointF(valuePixel, keyPixel); };
+  QVector<QLineF> positiveLines, negativeLines;
+  positiveLines.reserve(int(end-begin)*3);
+  for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
-    {
-      if (isSelected && mSelectionDecorator)
-        mSelectionDecorator->applyPen(painter);
-      else if (mTwoColored)
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-      else
-        painter->setPen(mPen);
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw backbone:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->high)), QPointF(keyPixel, valueAxis->coordToPixel(it->low)));
-      // draw open:
-      double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(keyPixel-pixelWidth, openPixel), QPointF(keyPixel, openPixel));
-      // draw close:
-      painter->drawLine(QPointF(keyPixel, closePixel), QPointF(keyPixel+pixelWidth, closePixel));
-    }
-  } else
+    QVector<QLineF> &lines = (!splitByTrend || it->close >= it->open) ? positiveLines : negativeLines;
+    double keyPixel = keyAxis->coordToPixel(it->key);
+    double openPixel = valueAxis->coordToPixel(it->open);
+    double closePixel = valueAxis->coordToPixel(it->close);
+    // backbone:
+    lines.append(QLineF(pixelPoint(keyPixel, valueAxis->coordToPixel(it->high)), pixelPoint(keyPixel, valueAxis->coordToPixel(it->low))));
+    // open:
+    double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
+    lines.append(QLineF(pixelPoint(keyPixel-pixelWidth, openPixel), pixelPoint(keyPixel, openPixel)));
+    // close:
+    lines.append(QLineF(pixelPoint(keyPixel, closePixel), pixelPoint(keyPixel+pixelWidth, closePixel)));
+  }
+  
+  // draw line groups:
+  if (isSelected && mSelectionDecorator)
+    mSelectionDecorator->applyPen(painter);
+  else if (mTwoColored)
+    painter->setPen(mPenPositive);
+  else
+    painter->setPen(mPen);
+  if (!positiveLines.isEmpty())
+    painter->drawLines(positiveLines);
+  if (!negativeLines.isEmpty())
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
-    {
-      if (isSelected && mSelectionDecorator)
-        mSelectionDecorator->applyPen(painter);
-      else if (mTwoColored)
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-      else
-        painter->setPen(mPen);
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw backbone:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->high), keyPixel), QPointF(valueAxis->coordToPixel(it->low), keyPixel));
-      // draw open:
-      double pixelWidth = getPixelWidth(it->key, keyPixel); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(openPixel, keyPixel-pixelWidth), QPointF(openPixel, keyPixel));
-      // draw close:
-      painter->drawLine(QPointF(closePixel, keyPixel), QPointF(closePixel, keyPixel+pixelWidth));
-    }
+    painter->setPen(mPenNegative);
+    painter->drawLines(negativeLines);
   }
 }
 
@@ -682,62 +1052,57 @@ void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDa
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  if (keyAxis->orientation() == Qt::Horizontal)
+  // collect the wicks and bodies of rising and falling candles separately, so each group can be
+  // drawn with a single pen/brush setup and one drawLines and drawRects call:
+  const bool splitByTrend = mTwoColored && !(isSelected && mSelectionDecorator);
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  auto pixelPoint = [keyIsHorizontal](double keyPixel, double valuePixel) { return keyIsHorizontal ? QPointF(keyPixel, valuePixel) : QPointF(valuePixel, keyPixel); };
+  QVector<QLineF> positiveWicks, negativeWicks;
+  QVector<QRectF> positiveBodies, negativeBodies;
+  positiveWicks.reserve(int(end-begin)*2);
+  positiveBodies.reserve(int(end-begin));
+  for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
-    {
-      if (isSelected && mSelectionDecorator)
-      {
-        mSelectionDecorator->applyPen(painter);
-        mSelectionDecorator->applyBrush(painter);
-      } else if (mTwoColored)
-      {
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-        painter->setBrush(it->close >= it->open ? mBrushPositive : mBrushNegative);
-      } else
-      {
-        painter->setPen(mPen);
-        painter->setBrush(mBrush);
-      }
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw high:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->high)), QPointF(keyPixel, valueAxis->coordToPixel(qMax(it->open, it->close))));
-      // draw low:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it->low)), QPointF(keyPixel, valueAxis->coordToPixel(qMin(it->open, it->close))));
-      // draw open-close box:
-      double pixelWidth = getPixelWidth(it->key, keyPixel);
-      painter->drawRect(QRectF(QPointF(keyPixel-pixelWidth, closePixel), QPointF(keyPixel+pixelWidth, openPixel)));
-    }
-  } else // keyAxis->orientation() == Qt::Vertical
+    const bool positive = !splitByTrend || it->close >= it->open;
+    QVector<QLineF> &wicks = positive ? positiveWicks : negativeWicks;
+    QVector<QRectF> &bodies = positive ? positiveBodies : negativeBodies;
+    double keyPixel = keyAxis->coordToPixel(it->key);
+    double openPixel = valueAxis->coordToPixel(it->open);
+    double closePixel = valueAxis->coordToPixel(it->close);
+    // high:
+    wicks.append(QLineF(pixelPoint(keyPixel, valueAxis->coordToPixel(it->high)), pixelPoint(keyPixel, valueAxis->coordToPixel(qMax(it->open, it->close)))));
+    // low:
+    wicks.append(QLineF(pixelPoint(keyPixel, valueAxis->coordToPixel(it->low)), pixelPoint(keyPixel, valueAxis->coordToPixel(qMin(it->open, it->close)))));
+    // open-close box:
+    double pixelWidth = getPixelWidth(it->key, keyPixel);
+    bodies.append(QRectF(pixelPoint(keyPixel-pixelWidth, closePixel), pixelPoint(keyPixel+pixelWidth, openPixel)));
+  }
+  
+  // draw candle groups:
+  if (isSelected && mSelectionDecorator)
   {
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it)
-    {
-      if (isSelected && mSelectionDecorator)
-      {
-        mSelectionDecorator->applyPen(painter);
-        mSelectionDecorator->applyBrush(painter);
-      } else if (mTwoColored)
-      {
-        painter->setPen(it->close >= it->open ? mPenPositive : mPenNegative);
-        painter->setBrush(it->close >= it->open ? mBrushPositive : mBrushNegative);
-      } else
-      {
-        painter->setPen(mPen);
-        painter->setBrush(mBrush);
-      }
-      double keyPixel = keyAxis->coordToPixel(it->key);
-      double openPixel = valueAxis->coordToPixel(it->open);
-      double closePixel = valueAxis->coordToPixel(it->close);
-      // draw high:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->high), keyPixel), QPointF(valueAxis->coordToPixel(qMax(it->open, it->close)), keyPixel));
-      // draw low:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it->low), keyPixel), QPointF(valueAxis->coordToPixel(qMin(it->open, it->close)), keyPixel));
-      // draw open-close box:
-      double pixelWidth = getPixelWidth(it->key, keyPixel);
-      painter->drawRect(QRectF(QPointF(closePixel, keyPixel-pixelWidth), QPointF(openPixel, keyPixel+pixelWidth)));
-    }
+    mSelectionDecorator->applyPen(painter);
+    mSelectionDecorator->applyBrush(painter);
+  } else if (mTwoColored)
+  {
+    painter->setPen(mPenPositive);
+    painter->setBrush(mBrushPositive);
+  } else
+  {
+    painter->setPen(mPen);
+    painter->setBrush(mBrush);
+  }
+  if (!positiveBodies.isEmpty())
+  {
+    painter->drawLines(positiveWicks);
+    painter->drawRects(positiveBodies);
+  }
+  if (!negativeBodies.isEmpty())
+  {
+    painter->setPen(mPenNegative);
+    painter->setBrush(mBrushNegative);
+    painter->drawLines(negativeWicks);
+    painter->drawRects(negativeBodies);
   }
 }
 
@@ -779,7 +1144,7 @@ double QCPFinancial::getPixelWidth(double key, double keyPixel) const
     case wtPlotCoords:
     {
       if (mKeyAxis)
-        result = mKeyAxis.data()->coordToPixel(key+mWidth*0.5)-keyPixel;
+        result = mKeyAxis.data()->coordToPixel(key+keyWidth()*0.5)-keyPixel;
       else
         qDebug() << Q_FUNC_INFO << "No key axis defined";
       break;
@@ -795,10 +1160,10 @@ double QCPFinancial::getPixelWidth(double key, double keyPixel) const
   
   Like \ref selectTest, this method returns the shortest distance of \a pos to the graphical
   representation of the plottable, and \a closestDataPoint will point to the respective data point.
+  If there are no data points between \a begin and \a end, \a closestDataPoint is left unchanged.
 */
 double QCPFinancial::ohlcSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const
 {
-  closestDataPoint = mDataContainer->constEnd();
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
@@ -842,10 +1207,10 @@ double QCPFinancial::ohlcSelectTest(const QPointF &pos, const QCPFinancialDataCo
   
   Like \ref selectTest, this method returns the shortest distance of \a pos to the graphical
   representation of the plottable, and \a closestDataPoint will point to the respective data point.
+  If there are no data points between \a begin and \a end, \a closestDataPoint is left unchanged.
 */
 double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const
 {
-  closestDataPoint = mDataContainer->constEnd();
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
@@ -857,7 +1222,7 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
     {
       double currentDistSqr;
       // determine whether pos is in open-close-box:
-      QCPRange boxKeyRange(it->key-mWidth*0.5, it->key+mWidth*0.5);
+      QCPRange boxKeyRange(it->key-keyWidth()*0.5, it->key+keyWidth()*0.5);
       QCPRange boxValueRange(it->close, it->open);
       double posKey, posValue;
       pixelsToCoords(pos, posKey, posValue);
@@ -884,7 +1249,7 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
     {
       double currentDistSqr;
       // determine whether pos is in open-close-box:
-      QCPRange boxKeyRange(it->key-mWidth*0.5, it->key+mWidth*0.5);
+      QCPRange boxKeyRange(it->key-keyWidth()*0.5, it->key+keyWidth()*0.5);
       QCPRange boxValueRange(it->close, it->open);
       double posKey, posValue;
       pixelsToCoords(pos, posKey, posValue);
@@ -912,7 +1277,8 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
 /*! \internal
   
   called by the drawing methods to determine which data (key) range is visible at the current key
-  axis range setting, so only that needs to be processed.
+  axis range setting, so only that needs to be processed. The iterators refer to \a data, which is
+  the displayed data container (see \ref displayedData).
   
   \a begin returns an iterator to the lowest data point that needs to be taken into account when
   plotting. Note that in order to get a clean plot all the way to the edge of the axis rect, \a
@@ -921,19 +1287,19 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
   \a end returns the iterator just above the highest data point that needs to be taken into
   account. Same as before, \a end may also lie just outside of the visible range
   
-  if the plottable contains no data, both \a begin and \a end point to \c constEnd.
+  if \a data is empty, both \a begin and \a end point to \c constEnd.
 */
-void QCPFinancial::getVisibleDataBounds(QCPFinancialDataContainer::const_iterator &begin, QCPFinancialDataContainer::const_iterator &end) const
+void QCPFinancial::getVisibleDataBounds(const QCPFinancialDataContainer &data, QCPFinancialDataContainer::const_iterator &begin, QCPFinancialDataContainer::const_iterator &end) const
 {
   if (!mKeyAxis)
   {
     qDebug() << Q_FUNC_INFO << "invalid key axis";
-    begin = mDataContainer->constEnd();
-    end = mDataContainer->constEnd();
+    begin = data.constEnd();
+    end = data.constEnd();
     return;
   }
-  begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower-mWidth*0.5); // subtract half width of ohlc/candlestick to include partially visible data points
-  end = mDataContainer->findEnd(mKeyAxis.data()->range().upper+mWidth*0.5); // add half width of ohlc/candlestick to include partially visible data points
+  begin = data.findBegin(mKeyAxis.data()->range().lower-keyWidth()*0.5); // subtract half width of ohlc/candlestick to include partially visible data points
+  end = data.findEnd(mKeyAxis.data()->range().upper+keyWidth()*0.5); // add half width of ohlc/candlestick to include partially visible data points
 }
 
 /*!  \internal
@@ -950,12 +1316,117 @@ QRectF QCPFinancial::selectionHitBox(QCPFinancialDataContainer::const_iterator i
   double keyPixel = keyAxis->coordToPixel(it->key);
   double highPixel = valueAxis->coordToPixel(it->high);
   double lowPixel = valueAxis->coordToPixel(it->low);
-  double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it->key-mWidth*0.5);
+  double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it->key-keyWidth()*0.5);
   if (keyAxis->orientation() == Qt::Horizontal)
     return QRectF(keyPixel-keyWidthPixels, highPixel, keyWidthPixels*2, lowPixel-highPixel).normalized();
   else
     return QRectF(highPixel, keyPixel-keyWidthPixels, lowPixel-highPixel, keyWidthPixels*2).normalized();
 }
+
+/*! \internal
+
+  Returns the width of a bar/candlestick in key coordinates. This is \ref setWidth, or, in the
+  timeframe pyramid mode (\ref setTimeframes), \ref setWidth as a fraction of the displayed
+  timeframe.
+*/
+double QCPFinancial::keyWidth() const
+{
+  if (mActiveTimeframe >= 0)
+    return mWidth*mTimeframes.at(mActiveTimeframe);
+  return mWidth;
+}
+
+/*! \internal
+
+  Returns the data container that is displayed: the aggregated data of the active timeframe level
+  in the timeframe pyramid mode (\ref setTimeframes), otherwise the plottable's data container
+  (\ref data).
+*/
+QSharedPointer<QCPFinancialDataContainer> QCPFinancial::displayedData() const
+{
+  if (mActiveTimeframe >= 0)
+    return mTimeframeLevels.at(mActiveTimeframe);
+  return mDataContainer;
+}
+
+/*!
+  Chooses the timeframe level that is displayed in the timeframe pyramid mode (\ref
+  setTimeframes): the finest timeframe whose candles are at least \ref setMinimumCandleWidth pixels
+  wide at the current key axis range (measured at the range center). If the level changes, the
+  current data selection is cleared, since its indices refer to the candles of the previous level.
+
+  This slot is connected to \ref QCustomPlot::afterLayout, which is emitted during a replot after
+  the axis rect geometry was updated, but before anything is drawn. So the level always follows the
+  current key axis (also after \ref setKeyAxis), its range and the axis rect size, but is never
+  changed while drawing, and data indices (e.g. of \ref selectTest) refer to the candles of the
+  last replot. It is also called by \ref setTimeframes and \ref setMinimumCandleWidth.
+  
+  \see activeTimeframe
+*/
+void QCPFinancial::updateActiveTimeframe()
+{
+  if (!mKeyAxis || mTimeframeLevels.isEmpty())
+    return;
+  const QCPAxis *keyAxis = mKeyAxis.data();
+  const double center = keyAxis->range().center();
+  const double centerPixel = keyAxis->coordToPixel(center);
+  int level = mTimeframes.size()-1;
+  for (int i=0; i<mTimeframes.size(); ++i)
+  {
+    if (qAbs(keyAxis->coordToPixel(center+mTimeframes.at(i))-centerPixel) >= mMinimumCandleWidth)
+    {
+      level = i;
+      break;
+    }
+  }
+  if (level != mActiveTimeframe)
+  {
+    mActiveTimeframe = level;
+    if (!mSelection.isEmpty())
+      setSelection(QCPDataSelection());
+  }
+}
+
+/*! \internal
+
+  Adds a single tick (\a price at \a time) to the OHLC \a candles with bins of size \a
+  timeBinSize. If the tick falls into the bin of the last candle, that candle is updated in place,
+  otherwise a new candle is appended. Ticks older than the last candle only extend the high/low of
+  their candle (or create it). Ticks with NaN time or price are ignored.
+  
+  Returns true if a new candle was created.
+*/
+bool QCPFinancial::addTickToCandles(QCPFinancialDataContainer &candles, double time, double price, double timeBinSize)
+{
+  if (qIsNaN(time) || qIsNaN(price))
+    return false;
+  const double key = std::floor(time/timeBinSize+0.5)*timeBinSize; // not qFloor, bin index may exceed int range
+  if (!candles.isEmpty())
+  {
+    const double lastKey = (candles.constEnd()-1)->key;
+    if (key == lastKey) // tick in current candle, update in place:
+    {
+      QCPFinancialDataContainer::iterator last = candles.end()-1;
+      if (price > last->high) last->high = price;
+      if (price < last->low) last->low = price;
+      last->close = price;
+      return false;
+    } else if (key < lastKey) // late tick, find its candle:
+    {
+      const QCPFinancialDataContainer::const_iterator candle = candles.findBegin(key, false);
+      if (candle != candles.constEnd() && candle->key == key)
+      {
+        const int candleIndex = int(candle-candles.constBegin()); // determine index before non-const begin() might detach
+        QCPFinancialDataContainer::iterator it = candles.begin()+candleIndex;
+        if (price > it->high) it->high = price;
+        if (price < it->low) it->low = price;
+        return false;
+      }
+    }
+  }
+  candles.add(QCPFinancialData(key, price, price, price, price));
+  return true;
+}
 /* end of 'src/plottables/plottable-financial.cpp' */
 
 
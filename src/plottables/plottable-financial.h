@@ -47,6 +47,8 @@ class QCP_LIB_DECL QCPFinancial : public QCPAbstractPlottable1D<QCPFinancialData
   Q_PROPERTY(QBrush brushNegative READ brushNegative WRITE setBrushNegative)
   Q_PROPERTY(QPen penPositive READ penPositive WRITE setPenPositive)
   Q_PROPERTY(QPen penNegative READ penNegative WRITE setPenNegative)
+  Q_PROPERTY(double minimumCandleWidth READ minimumCandleWidth WRITE setMinimumCandleWidth)
+  Q_PROPERTY(double tickTimeframe READ tickTimeframe WRITE setTickTimeframe)
   /// \endcond
 public:
   /*!
@@ -84,6 +86,10 @@ public:
   QBrush brushNegative() const { return mBrushNegative; }
   QPen penPositive() const { return mPenPositive; }
   QPen penNegative() const { return mPenNegative; }
+  QVector<double> timeframes() const { return mTimeframes; }
+  double minimumCandleWidth() const { return mMinimumCandleWidth; }
+  double tickTimeframe() const { return mTickTimeframe; }
+  double activeTimeframe() const { return mActiveTimeframe >= 0 ? mTimeframes.at(mActiveTimeframe) : 0; }
   
   // setters:
   void setData(QSharedPointer<QCPFinancialDataContainer> data);
@@ -96,12 +102,30 @@ public:
   void setBrushNegative(const QBrush &brush);
   void setPenPositive(const QPen &pen);
   void setPenNegative(const QPen &pen);
+  void setTimeframes(const QVector<double> &timeframes);
+  void setMinimumCandleWidth(double pixels);
+  void setTickTimeframe(double timeframe);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close, bool alreadySorted=false);
   void addData(double key, double open, double high, double low, double close);
+  void addTicks(const QVector<double> &time, const QVector<double> &price);
+  bool addTick(double time, double price);
+  QSharedPointer<QCPFinancialDataContainer> timeframeData(int level) const;
+  Q_SLOT void updateActiveTimeframe();
   
   // reimplemented virtual methods:
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual void dataMainKeys(int begin, int end, double *keys) const Q_DECL_OVERRIDE;
+  virtual void dataMainValues(int begin, int end, double *values) const Q_DECL_OVERRIDE;
+  virtual void dataPixelPositions(int begin, int end, QPointF *positions) const Q_DECL_OVERRIDE;
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
@@ -118,6 +142,13 @@ protected:
   bool mTwoColored;
   QBrush mBrushPositive, mBrushNegative;
   QPen mPenPositive, mPenNegative;
+  QVector<double> mTimeframes;
+  double mMinimumCandleWidth;
+  double mTickTimeframe;
+  
+  // non-property members:
+  QVector<QSharedPointer<QCPFinancialDataContainer> > mTimeframeLevels;
+  int mActiveTimeframe; // index of the displayed level in mTimeframeLevels, -1 if not in timeframe pyramid mode
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -129,8 +160,11 @@ protected:
   double getPixelWidth(double key, double keyPixel) const;
   double ohlcSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const;
   double candlestickSelectTest(const QPointF &pos, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, QCPFinancialDataContainer::const_iterator &closestDataPoint) const;
-  void getVisibleDataBounds(QCPFinancialDataContainer::const_iterator &begin, QCPFinancialDataContainer::const_iterator &end) const;
+  void getVisibleDataBounds(const QCPFinancialDataContainer &data, QCPFinancialDataContainer::const_iterator &begin, QCPFinancialDataContainer::const_iterator &end) const;
   QRectF selectionHitBox(QCPFinancialDataContainer::const_iterator it) const;
+  double keyWidth() const;
+  QSharedPointer<QCPFinancialDataContainer> displayedData() const;
+  static bool addTickToCandles(QCPFinancialDataContainer &candles, double time, double price, double timeBinSize);
   
   friend class QCustomPlot;
   friend class QCPLegend;
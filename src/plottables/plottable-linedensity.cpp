@@ -0,0 +1,495 @@
+#include "src/plottables/plottable-linedensity.h"
+#include "src/painter.h"
+#include "src/linerasterizer.h"
+#include "src/core.h"
+#include "src/parallel.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLineDensity
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLineDensity
+  \brief A plottable that shows many overlapping line traces as a colorized density image
+
+  When thousands of similar traces are overlaid (e.g. the repeated waveforms of an eye diagram),
+  drawing each of them as an individual \ref QCPGraph is slow, and blending semi-transparent pens
+  saturates quickly, so the frequency with which a certain pixel is crossed can't be read from the
+  plot anymore.
+
+  QCPLineDensity instead rasterizes the line segments of all its traces into an integer coverage
+  buffer which has the resolution of the axis rect. Each pixel of the buffer counts how many line
+  segments cross it. If the plottable is antialiased (\ref setAntialiased), the segments are
+  rasterized with Xiaolin Wu's algorithm, so partially covered pixels receive fractional counts.
+  The traces are distributed over all available CPU cores, each core rasterizing into a partial
+  buffer which is merged afterwards. Finally, the buffer is colorized with the color gradient (\ref
+  setGradient) and drawn as one image. Pixels which aren't crossed by any trace stay transparent.
+
+  Each trace is a \ref QCPGraphDataContainer, i.e. it has the same data layout as a \ref QCPGraph.
+  Traces are added with \ref addTrace, either by passing key/value vectors or by passing a shared
+  data container (which may also be the data container of a regular graph).
+
+  The density that is mapped to the gradient is given in units of fully covered pixels. By default,
+  the data range is adapted to the maximum density on every replot (\ref setAutoDataRange). Use a
+  logarithmic data scale (\ref setDataScaleType) to make rarely crossed pixels stand out more.
+
+  Traces with NaN values are interrupted at those points, just like graph lines.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn int QCPLineDensity::traceCount() const
+
+  Returns the number of traces that were added to this plottable.
+
+  \see addTrace, trace
+*/
+
+/* end of documentation of inline functions */
+
+/* start of documentation of signals */
+
+/*! \fn void QCPLineDensity::dataRangeChanged(const QCPRange &newRange);
+
+  This signal is emitted when the data range changes, either by a call to \ref setDataRange or by
+  the automatic adaption to the current density (see \ref setAutoDataRange).
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Constructs a line density plottable which uses \a keyAxis as its key axis ("x") and \a valueAxis
+  as its value axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance
+  and not have the same orientation.
+
+  The created QCPLineDensity is automatically registered with the QCustomPlot instance inferred
+  from \a keyAxis. This QCustomPlot instance takes ownership of the QCPLineDensity, so do not
+  delete it manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPLineDensity::QCPLineDensity(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mDataRange(0, 1),
+  mDataScaleType(QCPAxis::stLinear),
+  mGradient(QCPColorGradient::gpHot),
+  mAutoDataRange(true)
+{
+}
+
+QCPLineDensity::~QCPLineDensity()
+{
+}
+
+/*!
+  Returns the data container of the trace with the specified \a index, or a null pointer if the
+  index is out of bounds.
+
+  \see traceCount, addTrace
+*/
+QSharedPointer<QCPGraphDataContainer> QCPLineDensity::trace(int index) const
+{
+  if (index >= 0 && index < mTraces.size())
+    return mTraces.at(index);
+  qDebug() << Q_FUNC_INFO << "index out of bounds:" << index;
+  return QSharedPointer<QCPGraphDataContainer>();
+}
+
+/*!
+  Sets the density range that is mapped to the color gradient. The density of a pixel is given in
+  units of fully covered pixels, so a value of 1 corresponds to one trace crossing the pixel.
+
+  If \ref setAutoDataRange is enabled (the default), the range set here is replaced on the next
+  replot.
+*/
+void QCPLineDensity::setDataRange(const QCPRange &dataRange)
+{
+  if (!QCPRange::validRange(dataRange)) return;
+  if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
+  {
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      mDataRange = dataRange.sanitizedForLogScale();
+    else
+      mDataRange = dataRange.sanitizedForLinScale();
+    emit dataRangeChanged(mDataRange);
+  }
+}
+
+/*!
+  Sets whether the density is mapped to the color gradient linearly or logarithmically.
+*/
+void QCPLineDensity::setDataScaleType(QCPAxis::ScaleType scaleType)
+{
+  if (mDataScaleType != scaleType)
+  {
+    mDataScaleType = scaleType;
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      setDataRange(mDataRange.sanitizedForLogScale());
+  }
+}
+
+/*!
+  Sets the color gradient that is used to represent the density.
+*/
+void QCPLineDensity::setGradient(const QCPColorGradient &gradient)
+{
+  mGradient = gradient;
+}
+
+/*!
+  Sets whether the data range (\ref setDataRange) is adapted on each replot, such that it spans the
+  densities that are currently visible. With a linear data scale the range reaches from zero to the
+  maximum density, with a logarithmic data scale from the smallest nonzero to the maximum density.
+*/
+void QCPLineDensity::setAutoDataRange(bool enabled)
+{
+  mAutoDataRange = enabled;
+}
+
+/*!
+  Adds the trace \a data to this plottable and returns its index.
+
+  The container is shared, so modifying the data in it affects this plottable on the next replot.
+  This also allows sharing the data with a \ref QCPGraph.
+
+  \see removeTrace, clearTraces
+*/
+int QCPLineDensity::addTrace(QSharedPointer<QCPGraphDataContainer> data)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "passed data container is null";
+    return -1;
+  }
+  mTraces.append(data);
+  return mTraces.size()-1;
+}
+
+/*! \overload
+
+  Adds a trace consisting of the points given by \a keys and \a values, and returns its index. The
+  provided vectors should have equal length. Else, the number of added points will be the size of
+  the smallest vector.
+
+  If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
+  can set \a alreadySorted to true, to improve performance by saving a sorting run.
+*/
+int QCPLineDensity::addTrace(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  const int n = qMin(keys.size(), values.size());
+  QVector<QCPGraphData> tempData(n);
+  for (int i=0; i<n; ++i)
+  {
+    tempData[i].key = keys[i];
+    tempData[i].value = values[i];
+  }
+  QSharedPointer<QCPGraphDataContainer> container(new QCPGraphDataContainer);
+  container->set(tempData, alreadySorted);
+  return addTrace(container);
+}
+
+/*!
+  Removes the trace with the specified \a index. Returns true on success.
+
+  Note that the indices of all traces after the removed one decrease by one.
+*/
+bool QCPLineDensity::removeTrace(int index)
+{
+  if (index >= 0 && index < mTraces.size())
+  {
+    mTraces.removeAt(index);
+    return true;
+  }
+  qDebug() << Q_FUNC_INFO << "index out of bounds:" << index;
+  return false;
+}
+
+/*!
+  Removes all traces.
+*/
+void QCPLineDensity::clearTraces()
+{
+  mTraces.clear();
+}
+
+/*!
+  Returns the density at the pixel position \a pixelPos, as it was determined during the last
+  replot. The density is given in units of fully covered pixels. If \a pixelPos lies outside of
+  the axis rect or no replot has happened yet, returns 0.
+*/
+double QCPLineDensity::densityAt(const QPointF &pixelPos) const
+{
+  const QPoint pixel = pixelPos.toPoint();
+  if (!mDensityRect.contains(pixel) || mDensityBuffer.size() != mDensityRect.width()*mDensityRect.height())
+    return 0;
+  return mDensityBuffer.at((pixel.y()-mDensityRect.top())*mDensityRect.width() + pixel.x()-mDensityRect.left())/256.0;
+}
+
+/* inherits documentation from base class */
+double QCPLineDensity::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  if ((onlySelectable && mSelectable == QCP::stNone) || mTraces.isEmpty())
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+
+  // a hit is registered if any trace crossed a pixel in the selection tolerance around pos during the last replot:
+  const int tolerance = int(mParentPlot->selectionTolerance());
+  for (int dy=-tolerance; dy<=tolerance; ++dy)
+  {
+    for (int dx=-tolerance; dx<=tolerance; ++dx)
+    {
+      if (densityAt(pos+QPointF(dx, dy)) > 0)
+      {
+        if (details)
+          details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, like QCPColorMap
+        return mParentPlot->selectionTolerance()*0.99;
+      }
+    }
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPLineDensity::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  QCPRange result;
+  foundRange = false;
+  foreach (const QSharedPointer<QCPGraphDataContainer> &trace, mTraces)
+  {
+    bool foundTraceRange;
+    const QCPRange traceRange = trace->keyRange(foundTraceRange, inSignDomain);
+    if (foundTraceRange)
+    {
+      if (foundRange)
+        result.expand(traceRange);
+      else
+        result = traceRange;
+      foundRange = true;
+    }
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPLineDensity::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  QCPRange result;
+  foundRange = false;
+  foreach (const QSharedPointer<QCPGraphDataContainer> &trace, mTraces)
+  {
+    bool foundTraceRange;
+    const QCPRange traceRange = trace->valueRange(foundTraceRange, inSignDomain, inKeyRange);
+    if (foundTraceRange)
+    {
+      if (foundRange)
+        result.expand(traceRange);
+      else
+        result = traceRange;
+      foundRange = true;
+    }
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPLineDensity::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mKeyAxis.data()->range().size() <= 0 || mTraces.isEmpty()) return;
+  const QRect rect = clipRect();
+  if (rect.isEmpty()) return;
+
+  applyDefaultAntialiasingHint(painter);
+  rasterizeTraces(rect, painter->antialiasing());
+  updateDensityImage();
+
+  // the density image is already pixel aligned, so draw it without the antialiasing half-pixel shift:
+  painter->setAntialiasing(false);
+  painter->drawImage(rect.topLeft(), mDensityImage);
+}
+
+/* inherits documentation from base class */
+void QCPLineDensity::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  QCPColorGradient gradient(mGradient); // color() isn't const because it may update the color buffer
+  QLinearGradient legendGradient(rect.topLeft(), rect.topRight());
+  legendGradient.setColorAt(0, QColor::fromRgba(gradient.color(0.2, QCPRange(0, 1))));
+  legendGradient.setColorAt(1, QColor::fromRgba(gradient.color(1.0, QCPRange(0, 1))));
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(QPen(QBrush(legendGradient), 2));
+  painter->drawLine(QLineF(rect.left(), rect.bottom()-rect.height()*0.3, rect.right(), rect.top()+rect.height()*0.3));
+  painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()*0.3, rect.right(), rect.bottom()-rect.height()*0.3));
+}
+
+/*! \internal
+
+  Fills the density buffer with the accumulated line coverage of all traces, at the resolution of
+  the pixel rect \a rect (usually the axis rect). If \a antialiased is true, the coverage of each
+  segment is distributed onto the two pixels adjacent to the ideal line.
+
+  The traces are split into as many partitions as there are CPU cores. Each partition is rasterized
+  into its own partial buffer in parallel, so no synchronization is necessary during
+  rasterization. The partial buffers are summed up in parallel afterwards.
+*/
+void QCPLineDensity::rasterizeTraces(const QRect &rect, bool antialiased)
+{
+  const int pixelCount = rect.width()*rect.height();
+  mDensityRect = rect;
+  mDensityBuffer.fill(0, pixelCount);
+
+  const int partitionCount = qMax(1, qMin(QThread::idealThreadCount(), mTraces.size()));
+  QVector<QVector<quint32> > partialBuffers(partitionCount-1);
+  QVector<quint32> *partials = partialBuffers.data(); // raw access, so worker threads don't touch the outer vector's implicit sharing
+  quint32 *densityBuffer = mDensityBuffer.data();
+  const int traceCount = mTraces.size();
+  qcpParallelFor(0, partitionCount, 1, [&](int partitionBegin, int partitionEnd)
+  {
+    for (int p=partitionBegin; p<partitionEnd; ++p)
+    {
+      quint32 *buffer = densityBuffer;
+      if (p > 0)
+      {
+        partials[p-1].fill(0, pixelCount);
+        buffer = partials[p-1].data();
+      }
+      const int traceEnd = int(qint64(traceCount)*(p+1)/partitionCount);
+      for (int i=int(qint64(traceCount)*p/partitionCount); i<traceEnd; ++i)
+        rasterizeTrace(*mTraces.at(i), buffer, rect, antialiased);
+    }
+  });
+
+  if (partitionCount > 1)
+  {
+    qcpParallelFor(0, pixelCount, 16384, [&](int begin, int end)
+    {
+      for (int p=0; p<partitionCount-1; ++p)
+      {
+        const quint32 *partial = partials[p].constData();
+        for (int i=begin; i<end; ++i)
+          densityBuffer[i] += partial[i];
+      }
+    });
+  }
+}
+
+/*! \internal
+
+  Converts the density buffer into the density image, by colorizing it with the color gradient.
+  Pixels which aren't crossed by any trace are made transparent. If \ref setAutoDataRange is
+  enabled, the data range is adapted to the current densities first.
+*/
+void QCPLineDensity::updateDensityImage()
+{
+  const int width = mDensityRect.width();
+  const int height = mDensityRect.height();
+  if (mDensityImage.size() != mDensityRect.size())
+    mDensityImage = QImage(mDensityRect.size(), QImage::Format_ARGB32_Premultiplied);
+  const quint32 *densityBuffer = mDensityBuffer.constData();
+
+  if (mAutoDataRange)
+  {
+    quint32 minCount = std::numeric_limits<quint32>::max();
+    quint32 maxCount = 0;
+    const int pixelCount = width*height;
+    for (int i=0; i<pixelCount; ++i)
+    {
+      const quint32 count = densityBuffer[i];
+      if (count > maxCount)
+        maxCount = count;
+      if (count > 0 && count < minCount)
+        minCount = count;
+    }
+    if (maxCount > 0)
+    {
+      QCPRange newRange(mDataScaleType == QCPAxis::stLogarithmic ? minCount/256.0 : 0, maxCount/256.0);
+      if (newRange.upper <= newRange.lower)
+        newRange.upper = newRange.lower*2;
+      setDataRange(newRange);
+    }
+  }
+
+  const bool logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+  QVector<double> lineDensity(width);
+  double *lineDensityData = lineDensity.data();
+  for (int y=0; y<height; ++y)
+  {
+    const quint32 *counts = densityBuffer+y*width;
+    for (int x=0; x<width; ++x)
+      lineDensityData[x] = counts[x]/256.0;
+    QRgb *pixels = reinterpret_cast<QRgb*>(mDensityImage.scanLine(y));
+    mGradient.colorize(lineDensityData, mDataRange, pixels, width, 1, logarithmic);
+    for (int x=0; x<width; ++x)
+    {
+      if (counts[x] == 0)
+        pixels[x] = qRgba(0, 0, 0, 0);
+    }
+  }
+}
+
+/*! \internal
+
+  Rasterizes the visible part of \a trace into \a buffer, which has the size of \a rect. Consecutive
+  data points are connected by line segments, NaN values interrupt the trace.
+
+  This method is called concurrently from multiple threads (with different buffers), so it may only
+  read the state of this plottable.
+*/
+void QCPLineDensity::rasterizeTrace(const QCPGraphDataContainer &trace, quint32 *buffer, const QRect &rect, bool antialiased) const
+{
+  if (trace.isEmpty())
+    return;
+  const QCPRange keyRange = mKeyAxis.data()->range();
+  const QCPGraphDataContainer::const_iterator begin = trace.findBegin(keyRange.lower);
+  const QCPGraphDataContainer::const_iterator end = trace.findEnd(keyRange.upper);
+
+  const int width = rect.width();
+  const int height = rect.height();
+  const QRectF bufferClipRect(-1, -1, width+1, height+1);
+  // buffer coordinates have integer values at pixel centers:
+  const double offsetX = rect.left()+0.5;
+  const double offsetY = rect.top()+0.5;
+  bool hasPrevious = false;
+  double previousX = 0, previousY = 0;
+  for (QCPGraphDataContainer::const_iterator it=begin; it!=end; ++it)
+  {
+    double x, y;
+    coordsToPixels(it->key, it->value, x, y);
+    if (!qIsFinite(x) || !qIsFinite(y)) // NaNs create a gap in the trace
+    {
+      hasPrevious = false;
+      continue;
+    }
+    x -= offsetX;
+    y -= offsetY;
+    if (hasPrevious)
+    {
+      double x0 = previousX, y0 = previousY, x1 = x, y1 = y;
+      if (QCPLineRasterizer::clipSegment(x0, y0, x1, y1, bufferClipRect))
+        rasterizeSegment(buffer, width, height, x0, y0, x1, y1, antialiased);
+    }
+    previousX = x;
+    previousY = y;
+    hasPrevious = true;
+  }
+}
+
+/*! \internal
+
+  Adds the coverage of the line segment from (\a x0, \a y0) to (\a x1, \a y1) to \a buffer, which
+  is \a width by \a height pixels large. Coordinates are given in buffer pixels, with integer
+  values at pixel centers.
+
+  The segment is walked with \ref QCPLineRasterizer::traceSegment, so a long line made of many
+  short segments accumulates to a coverage of one per column, just like a single segment would. If
+  \a antialiased is true, the coverage of a column is split between the two pixels closest to the
+  ideal line, otherwise it's added to the nearest pixel.
+*/
+void QCPLineDensity::rasterizeSegment(quint32 *buffer, int width, int height, double x0, double y0, double x1, double y1, bool antialiased)
+{
+  QCPLineRasterizer::traceSegment(x0, y0, x1, y1, antialiased, QCPLineRasterizer::ecPartial, [buffer, width, height](int x, int y, double coverage)
+  {
+    if (x >= 0 && x < width && y >= 0 && y < height)
+      buffer[y*width+x] += quint32(coverage*256+0.5);
+  });
+}
+/* end of 'src/plottables/plottable-linedensity.cpp' */
@@ -0,0 +1,79 @@
+#pragma once
+#include "src/global.h"
+#include "src/plottable.h"
+#include "src/axis/axis.h"
+#include "src/colorgradient.h"
+#include "src/plottables/plottable-graph.h"
+
+class QCP_LIB_DECL QCPLineDensity : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QCPRange dataRange READ dataRange WRITE setDataRange NOTIFY dataRangeChanged)
+  Q_PROPERTY(QCPAxis::ScaleType dataScaleType READ dataScaleType WRITE setDataScaleType)
+  Q_PROPERTY(QCPColorGradient gradient READ gradient WRITE setGradient)
+  Q_PROPERTY(bool autoDataRange READ autoDataRange WRITE setAutoDataRange)
+  /// \endcond
+public:
+  explicit QCPLineDensity(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPLineDensity() Q_DECL_OVERRIDE;
+
+  // getters:
+  int traceCount() const { return mTraces.size(); }
+  QSharedPointer<QCPGraphDataContainer> trace(int index) const;
+  QCPRange dataRange() const { return mDataRange; }
+  QCPAxis::ScaleType dataScaleType() const { return mDataScaleType; }
+  QCPColorGradient gradient() const { return mGradient; }
+  bool autoDataRange() const { return mAutoDataRange; }
+
+  // setters:
+  Q_SLOT void setDataRange(const QCPRange &dataRange);
+  void setDataScaleType(QCPAxis::ScaleType scaleType);
+  void setGradient(const QCPColorGradient &gradient);
+  void setAutoDataRange(bool enabled);
+
+  // non-property methods:
+  int addTrace(QSharedPointer<QCPGraphDataContainer> data);
+  int addTrace(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  bool removeTrace(int index);
+  void clearTraces();
+  double densityAt(const QPointF &pixelPos) const;
+
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+
+signals:
+  void dataRangeChanged(const QCPRange &newRange);
+
+protected:
+  // property members:
+  QList<QSharedPointer<QCPGraphDataContainer> > mTraces;
+  QCPRange mDataRange;
+  QCPAxis::ScaleType mDataScaleType;
+  QCPColorGradient mGradient;
+  bool mAutoDataRange;
+
+  // non-property members:
+  QVector<quint32> mDensityBuffer; // accumulated line coverage per pixel, in units of 1/256 of a fully covered pixel
+  QRect mDensityRect; // the pixel rect the density buffer was rasterized for
+  QImage mDensityImage;
+
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+
+  // introduced virtual methods:
+  virtual void rasterizeTraces(const QRect &rect, bool antialiased);
+  virtual void updateDensityImage();
+
+  // non-virtual methods:
+  void rasterizeTrace(const QCPGraphDataContainer &trace, quint32 *buffer, const QRect &rect, bool antialiased) const;
+  static void rasterizeSegment(quint32 *buffer, int width, int height, double x0, double y0, double x1, double y1, bool antialiased);
+
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
+/* end of 'src/plottables/plottable-linedensity.h' */
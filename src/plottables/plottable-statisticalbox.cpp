@@ -1,5 +1,6 @@
 #include "src/plottables/plottable-statisticalbox.h"
 #include "src/layoutelements/layoutelement-axisrect.h"
+#include "src/parallel.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPStatisticalBoxData
@@ -173,6 +174,9 @@ QCPStatisticalBoxData::QCPStatisticalBoxData(double key, double minimum, double
   ownership of the plottable, so do not delete it manually but use QCustomPlot::removePlottable() instead.
   The newly created plottable can be modified, e.g.:
   \snippet documentation/doc-code-snippets/mainwindow.cpp qcpstatisticalbox-creation-2
+  
+  If the statistics of the boxes aren't known yet, they can be computed from the raw samples of
+  each box with \ref addSamples, see also \ref sampleStatistics.
 */
 
 /* start documentation of inline functions */
@@ -380,6 +384,143 @@ void QCPStatisticalBox::addData(double key, double minimum, double lowerQuartile
   mDataContainer->add(QCPStatisticalBoxData(key, minimum, lowerQuartile, median, upperQuartile, maximum, outliers));
 }
 
+/*! \overload
+  
+  Computes the statistics of the \a count raw \a samples (see \ref sampleStatistics) and adds
+  them as a data point at \a key. \a whiskerRule defines how whiskers and outliers are determined.
+  
+  \see addData
+*/
+void QCPStatisticalBox::addSamples(double key, const double *samples, int count, WhiskerRule whiskerRule)
+{
+  mDataContainer->add(sampleStatistics(key, samples, count, whiskerRule));
+}
+
+/*! \overload
+  
+  Computes the statistics of the raw samples of multiple boxes at once, and adds them as data
+  points. The samples of the box at \a keys[i] are given by \a samples[i]. If the two vectors have
+  different sizes, the number of added boxes will be the size of the smaller vector.
+  
+  The boxes are independent of each other and thus computed in parallel. \a whiskerRule defines
+  how whiskers and outliers are determined.
+  
+  \see sampleStatistics, addData
+*/
+void QCPStatisticalBox::addSamples(const QVector<double> &keys, const QVector<QVector<double> > &samples, WhiskerRule whiskerRule)
+{
+  if (keys.size() != samples.size())
+    qDebug() << Q_FUNC_INFO << "keys and samples have different sizes:" << keys.size() << samples.size();
+  const int n = qMin(keys.size(), samples.size());
+  QVector<QCPStatisticalBoxData> tempData(n);
+  QCPStatisticalBoxData *tempDataPtr = tempData.data();
+  qcpParallelFor(0, n, 1, [tempDataPtr, &keys, &samples, whiskerRule](int boxBegin, int boxEnd)
+  {
+    QVector<double> workBuffer; // reused for all boxes of this chunk
+    for (int i=boxBegin; i<boxEnd; ++i)
+      tempDataPtr[i] = calculateStatistics(keys.at(i), samples.at(i).constData(), samples.at(i).size(), whiskerRule, workBuffer);
+  });
+  mDataContainer->add(tempData, false); // don't modify tempData beyond this to prevent copy on write
+}
+
+/*!
+  Computes the box statistics of the \a count raw \a samples and returns them as a data point at
+  \a key, which can be passed to the data container.
+  
+  The quartiles and the median are determined with linear interpolation between the closest ranks
+  (like the default of R and NumPy). Instead of sorting the samples, they are found by selection
+  (\c std::nth_element), so the cost is linear in \a count. The whiskers and outliers are
+  determined according to \a whiskerRule. NaN samples are ignored.
+  
+  If there are no valid samples, all statistics of the returned data point are NaN.
+  
+  \see addSamples
+*/
+QCPStatisticalBoxData QCPStatisticalBox::sampleStatistics(double key, const double *samples, int count, WhiskerRule whiskerRule)
+{
+  QVector<double> workBuffer;
+  return calculateStatistics(key, samples, count, whiskerRule, workBuffer);
+}
+
+/*! \internal
+  
+  Implements \ref sampleStatistics. \a workBuffer is used as scratch space for the sample
+  selection, passing the same buffer for multiple boxes avoids reallocations. The outliers are
+  allocated with their exact size, so a data point doesn't hold on to unused capacity.
+*/
+QCPStatisticalBoxData QCPStatisticalBox::calculateStatistics(double key, const double *samples, int count, WhiskerRule whiskerRule, QVector<double> &workBuffer)
+{
+  // copy valid samples to the work buffer, since selection reorders it:
+  workBuffer.resize(count);
+  int n = 0;
+  for (int i=0; i<count; ++i)
+  {
+    if (!qIsNaN(samples[i]))
+      workBuffer[n++] = samples[i];
+  }
+  if (n == 0)
+  {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    return QCPStatisticalBoxData(key, nan, nan, nan, nan, nan);
+  }
+  
+  double *first = workBuffer.data();
+  double *last = first+n;
+  auto quantile = [first, last, n](double q)
+  {
+    const double position = q*(n-1);
+    const int lowerRank = int(position);
+    const double fraction = position-lowerRank;
+    std::nth_element(first, first+lowerRank, last);
+    double result = first[lowerRank];
+    if (fraction > 0 && lowerRank+1 < n) // interpolate with next rank, which is the minimum of the upper partition
+      result += fraction*(*std::min_element(first+lowerRank+1, last)-result);
+    return result;
+  };
+  QCPStatisticalBoxData result;
+  result.key = key;
+  result.median = quantile(0.5);
+  result.lowerQuartile = quantile(0.25);
+  result.upperQuartile = quantile(0.75);
+  
+  switch (whiskerRule)
+  {
+    case wrTukey:
+    {
+      const double interQuartileRange = result.upperQuartile-result.lowerQuartile;
+      const double lowerFence = result.lowerQuartile-1.5*interQuartileRange;
+      const double upperFence = result.upperQuartile+1.5*interQuartileRange;
+      result.minimum = result.lowerQuartile;
+      result.maximum = result.upperQuartile;
+      // move the outliers behind the samples within the fences:
+      double *outliersBegin = std::partition(first, last, [lowerFence, upperFence](double sample) { return sample >= lowerFence && sample <= upperFence; });
+      for (const double *it=first; it!=outliersBegin; ++it)
+      {
+        if (*it < result.minimum)
+          result.minimum = *it;
+        else if (*it > result.maximum)
+          result.maximum = *it;
+      }
+      if (outliersBegin != last)
+      {
+        std::sort(outliersBegin, last);
+        result.outliers.reserve(int(last-outliersBegin));
+        for (const double *it=outliersBegin; it!=last; ++it)
+          result.outliers.append(*it);
+      }
+      break;
+    }
+    case wrMinMax:
+    {
+      const std::pair<double*, double*> minMax = std::minmax_element(first, last);
+      result.minimum = *minMax.first;
+      result.maximum = *minMax.second;
+      break;
+    }
+  }
+  return result;
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::selectTestRect
 */
@@ -528,11 +669,13 @@ void QCPStatisticalBox::draw(QCPPainter *painter)
         painter->setPen(mPen);
         painter->setBrush(mBrush);
       }
-      QCPScatterStyle finalOutlierStyle = mOutlierStyle;
-      if (isSelectedSegment && mSelectionDecorator)
-        finalOutlierStyle = mSelectionDecorator->getFinalScatterStyle(mOutlierStyle);
-      drawStatisticalBox(painter, it, finalOutlierStyle);
+      drawStatisticalBox(painter, it, QCPScatterStyle()); // outliers are drawn below, for all boxes of the segment at once
     }
+    
+    QCPScatterStyle finalOutlierStyle = mOutlierStyle;
+    if (isSelectedSegment && mSelectionDecorator)
+      finalOutlierStyle = mSelectionDecorator->getFinalScatterStyle(mOutlierStyle);
+    drawOutliers(painter, begin, end, finalOutlierStyle);
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -556,7 +699,9 @@ void QCPStatisticalBox::drawLegendIcon(QCPPainter *painter, const QRectF &rect)
   Draws the graphical representation of a single statistical box with the data given by the
   iterator \a it with the provided \a painter.
 
-  If the statistical box has a set of outlier data points, they are drawn with \a outlierStyle.
+  If the statistical box has a set of outlier data points, they are drawn with \a outlierStyle,
+  unless it has the shape \ref QCPScatterStyle::ssNone. \ref draw uses the latter, and draws the
+  outliers of all boxes at once with \ref drawOutliers.
 
   \see getQuartileBox, getWhiskerBackboneLines, getWhiskerBarLines
 */
@@ -579,10 +724,31 @@ void QCPStatisticalBox::drawStatisticalBox(QCPPainter *painter, QCPStatisticalBo
   painter->setPen(mWhiskerBarPen);
   painter->drawLines(getWhiskerBarLines(it));
   // draw outliers:
+  if (!outlierStyle.isNone())
+    drawOutliers(painter, it, it+1, outlierStyle);
+}
+
+/*! \internal
+  
+  Draws the outliers of the data points from \a begin to \a end-1 with the provided \a painter,
+  using \a outlierStyle. The painter state is set up once, and all outliers are drawn with a single
+  call to \ref QCPScatterStyle::drawShapes.
+*/
+void QCPStatisticalBox::drawOutliers(QCPPainter *painter, QCPStatisticalBoxDataContainer::const_iterator begin, QCPStatisticalBoxDataContainer::const_iterator end, const QCPScatterStyle &outlierStyle) const
+{
+  if (outlierStyle.isNone())
+    return;
+  QVector<QPointF> outlierPixels;
+  for (QCPStatisticalBoxDataContainer::const_iterator it=begin; it!=end; ++it)
+  {
+    for (QVector<double>::const_iterator outlier=it->outliers.constBegin(); outlier!=it->outliers.constEnd(); ++outlier)
+      outlierPixels.append(coordsToPixels(it->key, *outlier));
+  }
+  if (outlierPixels.isEmpty())
+    return;
   applyScattersAntialiasingHint(painter);
   outlierStyle.applyTo(painter, mPen);
-  for (int i=0; i<it->outliers.size(); ++i)
-    outlierStyle.drawShape(painter, coordsToPixels(it->key, it->outliers.at(i)));
+  outlierStyle.drawShapes(painter, outlierPixels);
 }
 
 /*!  \internal
@@ -56,6 +56,17 @@ class QCP_LIB_DECL QCPStatisticalBox : public QCPAbstractPlottable1D<QCPStatisti
   Q_PROPERTY(QCPScatterStyle outlierStyle READ outlierStyle WRITE setOutlierStyle)
   /// \endcond
 public:
+  /*!
+    Defines how the whiskers and outliers are determined when computing box statistics from raw
+    samples.
+    
+    \see addSamples, sampleStatistics
+  */
+  enum WhiskerRule { wrTukey   ///< Whiskers end at the most extreme samples within 1.5 interquartile ranges from the box, samples beyond are outliers (Tukey's rule)
+                     ,wrMinMax ///< Whiskers end at the sample minimum and maximum, there are no outliers
+                   };
+  Q_ENUMS(WhiskerRule)
+  
   explicit QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis);
   
   // getters:
@@ -82,6 +93,8 @@ public:
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &minimum, const QVector<double> &lowerQuartile, const QVector<double> &median, const QVector<double> &upperQuartile, const QVector<double> &maximum, bool alreadySorted=false);
   void addData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers=QVector<double>());
+  void addSamples(double key, const double *samples, int count, WhiskerRule whiskerRule=wrTukey);
+  void addSamples(const QVector<double> &keys, const QVector<QVector<double> > &samples, WhiskerRule whiskerRule=wrTukey);
   
   // reimplemented virtual methods:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
@@ -89,6 +102,9 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
+  // static methods:
+  static QCPStatisticalBoxData sampleStatistics(double key, const double *samples, int count, WhiskerRule whiskerRule=wrTukey);
+  
 protected:
   // property members:
   double mWidth;
@@ -110,6 +126,8 @@ protected:
   QRectF getQuartileBox(QCPStatisticalBoxDataContainer::const_iterator it) const;
   QVector<QLineF> getWhiskerBackboneLines(QCPStatisticalBoxDataContainer::const_iterator it) const;
   QVector<QLineF> getWhiskerBarLines(QCPStatisticalBoxDataContainer::const_iterator it) const;
+  void drawOutliers(QCPPainter *painter, QCPStatisticalBoxDataContainer::const_iterator begin, QCPStatisticalBoxDataContainer::const_iterator end, const QCPScatterStyle &outlierStyle) const;
+  static QCPStatisticalBoxData calculateStatistics(double key, const double *samples, int count, WhiskerRule whiskerRule, QVector<double> &workBuffer);
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -467,6 +467,155 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
     }
   }
 }
+
+/*!
+  Draws the scatter shape with \a painter at all \a positions at once.
+  
+  Instead of one draw call per scatter like \ref drawShape, the shapes are drawn with a single
+  call: Dots with one \c drawPoints call, and the other geometric shapes as one painter path, which
+  is stroked and filled once. Overlapping filled shapes are filled as their union. Pixmap and
+  custom shapes are still drawn one by one.
+  
+  Like \ref drawShape, this function does not modify the pen or the brush on the painter.
+  
+  \see applyTo
+*/
+void QCPScatterStyle::drawShapes(QCPPainter *painter, const QVector<QPointF> &positions) const
+{
+  if (positions.isEmpty())
+    return;
+  switch (mShape)
+  {
+    case ssNone: return;
+    case ssDot:
+    {
+      painter->drawPoints(positions.constData(), positions.size());
+      return;
+    }
+    case ssPixmap:
+    case ssCustom:
+    {
+      for (int i=0; i<positions.size(); ++i)
+        drawShape(painter, positions.at(i));
+      return;
+    }
+    default: break;
+  }
+  
+  const double w = mSize/2.0;
+  QPainterPath path;
+  path.setFillRule(Qt::WindingFill); // overlapping shapes are filled as their union
+  auto addLine = [&path](double x1, double y1, double x2, double y2) { path.moveTo(x1, y1); path.lineTo(x2, y2); };
+  auto addPolygon = [&path](const QPointF *points, int count)
+  {
+    path.moveTo(points[0]);
+    for (int i=1; i<count; ++i)
+      path.lineTo(points[i]);
+    path.closeSubpath();
+  };
+  for (int i=0; i<positions.size(); ++i)
+  {
+    const double x = positions.at(i).x();
+    const double y = positions.at(i).y();
+    switch (mShape)
+    {
+      case ssCross:
+      {
+        addLine(x-w, y-w, x+w, y+w);
+        addLine(x-w, y+w, x+w, y-w);
+        break;
+      }
+      case ssPlus:
+      {
+        addLine(x-w, y, x+w, y);
+        addLine(x, y+w, x, y-w);
+        break;
+      }
+      case ssCircle:
+      case ssDisc:
+      {
+        path.addEllipse(QPointF(x, y), w, w);
+        break;
+      }
+      case ssSquare:
+      {
+        path.addRect(QRectF(x-w, y-w, mSize, mSize));
+        break;
+      }
+      case ssDiamond:
+      {
+        const QPointF points[4] = {QPointF(x-w, y), QPointF(x, y-w), QPointF(x+w, y), QPointF(x, y+w)};
+        addPolygon(points, 4);
+        break;
+      }
+      case ssStar:
+      {
+        addLine(x-w, y, x+w, y);
+        addLine(x, y+w, x, y-w);
+        addLine(x-w*0.707, y-w*0.707, x+w*0.707, y+w*0.707);
+        addLine(x-w*0.707, y+w*0.707, x+w*0.707, y-w*0.707);
+        break;
+      }
+      case ssTriangle:
+      {
+        const QPointF points[3] = {QPointF(x-w, y+0.755*w), QPointF(x+w, y+0.755*w), QPointF(x, y-0.977*w)};
+        addPolygon(points, 3);
+        break;
+      }
+      case ssTriangleInverted:
+      {
+        const QPointF points[3] = {QPointF(x-w, y-0.755*w), QPointF(x+w, y-0.755*w), QPointF(x, y+0.977*w)};
+        addPolygon(points, 3);
+        break;
+      }
+      case ssCrossSquare:
+      {
+        path.addRect(QRectF(x-w, y-w, mSize, mSize));
+        addLine(x-w, y-w, x+w*0.95, y+w*0.95);
+        addLine(x-w, y+w*0.95, x+w*0.95, y-w);
+        break;
+      }
+      case ssPlusSquare:
+      {
+        path.addRect(QRectF(x-w, y-w, mSize, mSize));
+        addLine(x-w, y, x+w*0.95, y);
+        addLine(x, y+w, x, y-w);
+        break;
+      }
+      case ssCrossCircle:
+      {
+        path.addEllipse(QPointF(x, y), w, w);
+        addLine(x-w*0.707, y-w*0.707, x+w*0.670, y+w*0.670);
+        addLine(x-w*0.707, y+w*0.670, x+w*0.670, y-w*0.707);
+        break;
+      }
+      case ssPlusCircle:
+      {
+        path.addEllipse(QPointF(x, y), w, w);
+        addLine(x-w, y, x+w, y);
+        addLine(x, y+w, x, y-w);
+        break;
+      }
+      case ssPeace:
+      {
+        path.addEllipse(QPointF(x, y), w, w);
+        addLine(x, y-w, x, y+w);
+        addLine(x, y, x-w*0.707, y+w*0.707);
+        addLine(x, y, x+w*0.707, y+w*0.707);
+        break;
+      }
+      default: break;
+    }
+  }
+  if (mShape == ssDisc)
+  {
+    const QBrush brushBackup = painter->brush();
+    painter->setBrush(painter->pen().color());
+    painter->drawPath(path);
+    painter->setBrush(brushBackup);
+  } else
+    painter->drawPath(path);
+}
 /* end of 'src/scatterstyle.cpp' */
 
 
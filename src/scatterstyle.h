@@ -85,6 +85,7 @@ public:
   void applyTo(QCPPainter *painter, const QPen &defaultPen) const;
   void drawShape(QCPPainter *painter, const QPointF &pos) const;
   void drawShape(QCPPainter *painter, double x, double y) const;
+  void drawShapes(QCPPainter *painter, const QVector<QPointF> &positions) const;
 
 protected:
   // property members: